@@ -13,8 +13,6 @@
 
 #define DHM_ALIGN 16
 
-typedef uint64_t (*lum_hash_func)(const void *key, size_t len);
-
 typedef struct {
     void *key;           // Pointer to key
     void *value;         // Pointer to value
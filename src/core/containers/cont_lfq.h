@@ -8,41 +8,57 @@
 #include <stdatomic.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <assert.h>
 #include <stdio.h>
 
-typedef struct {
-    size_t index;  // Queue head index
-    size_t version; // Version counter
-} tagged_pointer_t;
+// Bounded MPMC queue (D. Vyukov's sequence-slot design).
+// Every cell carries a sequence number telling which lap it is ready for:
+// seq == pos means free for the producer of position pos, seq == pos + 1 means
+// it holds that producer's item. Producers and consumers claim positions with a
+// CAS on tail/head and hand the cell over with a release store of its sequence.
+typedef struct
+{
+    atomic_size_t sequence;
+    void         *data;
+} lum_lfq_cell_t;
 
 // Defines a lockless queue type
-typedef struct {
-    atomic_size_t tail;
-    atomic_size_t capacity;
-    void **buffer;
-    lum_allocator *allocator;
-    atomic_uintptr_t head; // Atomic tagged pointer
+typedef struct
+{
+    CACHE_ALIGNED atomic_size_t head; // Next position to dequeue (consumers)
+    CACHE_ALIGNED atomic_size_t tail; // Next position to enqueue (producers)
+    CACHE_ALIGNED size_t capacity;    // Power of two
+    size_t          mask;
+    lum_lfq_cell_t *buffer;
+    lum_allocator  *allocator;
 } lum_lfq_t;
 
-// Initialize queue with given capacity (stack or heap)
+// Initialize queue with given capacity, rounded up to a power of two.
+// The queue struct itself must be allocated with _Alignof(lum_lfq_t).
 static inline bool lum_lfq_init(lum_lfq_t *queue, size_t capacity, lum_allocator *allocator)
 {
     if (!queue || !allocator)
         return false;
 
-    // if (!lum_is_power_of_two(capacity))
-    //     capacity = 1 << lum_log2_ceil(capacity);
-
     if (capacity < 2)
         return false; // Minimum capacity is 2
 
-    queue->capacity  = capacity + 1;
+    if (!lum_is_power_of_two(capacity))
+        capacity = lum_next_power_of_two((uint32_t) capacity);
+
+    queue->capacity  = capacity;
+    queue->mask      = capacity - 1;
     queue->allocator = allocator;
-    queue->buffer    = allocator->alloc(allocator, queue->capacity * sizeof(void *), 16);
+    queue->buffer    = allocator->alloc(allocator, capacity * sizeof(lum_lfq_cell_t), 64);
     if (!queue->buffer)
         return false;
 
+    for (size_t i = 0; i < capacity; i++)
+    {
+        atomic_store_explicit(&queue->buffer[i].sequence, i, memory_order_relaxed);
+        queue->buffer[i].data = NULL;
+    }
     atomic_store_explicit(&queue->head, 0, memory_order_relaxed);
     atomic_store_explicit(&queue->tail, 0, memory_order_relaxed);
     return true;
@@ -74,77 +90,154 @@ static inline void lum_lfq_free(lum_lfq_t **queue)
         allocator->free(allocator, allocator);
 }
 
-// Check if queue is empty
-static inline bool lum_lfq_empty(lum_lfq_t *queue)
+// Free the buffer of a queue whose struct is owned by the caller
+static inline void lum_lfq_destroy(lum_lfq_t *queue)
+{
+    if (!queue || !queue->buffer)
+        return;
+    queue->allocator->free(queue->allocator, queue->buffer);
+    queue->buffer = NULL;
+}
+
+// Approximate number of items (exact when the queue is quiescent)
+static inline size_t lum_lfq_size(lum_lfq_t *queue)
 {
     assert(queue != NULL);
-    size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
     size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
-    return (head % queue->capacity) == (tail % queue->capacity);
+    return tail > head ? tail - head : 0;
+}
+
+// Check if queue is empty
+static inline bool lum_lfq_empty(lum_lfq_t *queue)
+{
+    return lum_lfq_size(queue) == 0;
 }
 
 // Check if queue is full
 static inline bool lum_lfq_full(lum_lfq_t *queue)
 {
-    assert(queue != NULL);
-    size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
-    return ((atomic_load_explicit(&queue->tail, memory_order_relaxed) + 1) & (queue->capacity - 1)) == head;
+    return lum_lfq_size(queue) >= queue->capacity;
 }
 
-// Push to queue
+// Push to queue. Returns false when full.
 static inline bool lum_lfq_enqueue(lum_lfq_t *queue, void *item)
 {
-    uintptr_t packed_tail, packed_head;
-    size_t next_tail;
-
-    do {
-        packed_tail = atomic_load(&queue->tail);
-        packed_head = atomic_load_explicit(&queue->head, memory_order_acquire);
-
-        size_t tail_index = packed_tail % (queue->capacity - 1);
-        size_t head_index = packed_head % (queue->capacity - 1);
-
-        // Full Condition
-        next_tail = (packed_tail + 1) % (queue->capacity);
-        if (head_index == next_tail) {
-            return false; // Queue is full
+    lum_lfq_cell_t *cell;
+    size_t          pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    for (;;)
+    {
+        cell          = &queue->buffer[pos & queue->mask];
+        size_t   seq  = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+
+        if (diff == 0)
+        {
+            // Cell is free for this lap: claim the position
+            if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
         }
+        else if (diff < 0)
+        {
+            return false; // Queue is full (previous lap not consumed yet)
+        }
+        else
+        {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+        }
+    }
 
-        // Store the item before updating tail
-        queue->buffer[tail_index] = item;
-
-    } while (!atomic_compare_exchange_weak(&queue->tail, &packed_tail, (packed_tail + 1)));
-
+    cell->data = item;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
     return true;
 }
 
-static inline void *lum_lfq_dequeue(lum_lfq_t *queue)
+// Push up to `count` items reserving all their slots with a single CAS on tail.
+// Returns the number of items enqueued (fewer than count when the queue fills up).
+static inline size_t lum_lfq_enqueue_bulk(lum_lfq_t *queue, void *const *items, size_t count)
 {
-    uintptr_t packed_head, packed_tail;
-    size_t next_head;
-    void *item;
-
-    do {
-        packed_head = atomic_load(&queue->head);
-        packed_tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
-
-        size_t head_index = packed_head % (queue->capacity /*- 1*/);
-        size_t tail_index = packed_tail % (queue->capacity /*- 1*/);
-
-        // Empty Condition
-        if (head_index == tail_index) {
-            return NULL; // Queue is empty
+    size_t pos = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+    size_t n;
+
+    for (;;)
+    {
+        // Every position below head has been claimed by a consumer, so the
+        // previous lap of the reserved cells is at worst still being read.
+        size_t   head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        intptr_t used = (intptr_t) (pos - head);
+        if (used < 0)
+        {
+            pos = atomic_load_explicit(&queue->tail, memory_order_relaxed); // Stale tail
+            continue;
+        }
+        if ((size_t) used >= queue->capacity)
+            return 0; // Queue is full
+
+        n = queue->capacity - (size_t) used;
+        if (n > count)
+            n = count;
+        if (atomic_compare_exchange_weak_explicit(&queue->tail, &pos, pos + n,
+                                                  memory_order_relaxed, memory_order_relaxed))
+            break;
+    }
+
+    for (size_t i = 0; i < n; i++)
+    {
+        lum_lfq_cell_t *cell = &queue->buffer[(pos + i) & queue->mask];
+
+        // Wait for a consumer that claimed the previous lap to finish reading it
+        for (int spins = 0; atomic_load_explicit(&cell->sequence, memory_order_acquire) != pos + i;
+             spins++)
+        {
+            if (spins < 64)
+                lum_cpu_relax();
+            else
+                lum_thread_yield(); // The consumer may have been preempted
         }
 
-        // Read item before updating head
-        item = queue->buffer[head_index];
-
-        next_head = (head_index + 1) % queue->capacity;
+        cell->data = items[i];
+        atomic_store_explicit(&cell->sequence, pos + i + 1, memory_order_release);
+    }
+    return n;
+}
 
-    } while (!atomic_compare_exchange_weak(&queue->head, &packed_head, packed_head + 1));
+// Pop from queue. Returns NULL when empty.
+static inline void *lum_lfq_dequeue(lum_lfq_t *queue)
+{
+    lum_lfq_cell_t *cell;
+    size_t          pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    for (;;)
+    {
+        cell          = &queue->buffer[pos & queue->mask];
+        size_t   seq  = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+
+        if (diff == 0)
+        {
+            // Cell holds this lap's item: claim the position
+            if (atomic_compare_exchange_weak_explicit(&queue->head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return NULL; // Queue is empty (or the producer has not published yet)
+        }
+        else
+        {
+            pos = atomic_load_explicit(&queue->head, memory_order_relaxed);
+        }
+    }
 
+    void *item = cell->data;
+    // Hand the cell to the producer of the next lap
+    atomic_store_explicit(&cell->sequence, pos + queue->mask + 1, memory_order_release);
     return item;
 }
 
-
 #endif // LUM_CONT_LOCK_FREE_QUEUE_H
@@ -0,0 +1,124 @@
+#include "cont_shm.h"
+
+#define SHM_ALIGN 16 // Control bytes are loaded a group at a time
+
+// Largest power of two dividing `size`, at most SHM_ALIGN
+static size_t shm_alignment(size_t size)
+{
+    size_t alignment = size & (~size + 1);
+    return alignment == 0 || alignment > SHM_ALIGN ? SHM_ALIGN : alignment;
+}
+
+// Move every entry into a fresh table of `capacity` slots, dropping the tombstones
+static bool shm_rehash(lum_shm_t *map, size_t capacity)
+{
+    lum_allocator *allocator = map->allocator;
+    int8_t        *ctrl      = allocator->alloc(allocator, capacity * (1 + map->slot_size),
+                                                SHM_ALIGN);
+    if (!ctrl)
+        return false;
+
+    lum_shm_t old    = *map;
+    map->ctrl        = ctrl;
+    map->slots       = (unsigned char *) ctrl + capacity;
+    map->capacity    = capacity;
+    map->growth_left = lum_shm_growth_limit(capacity) - map->count;
+    memset(ctrl, LUM_SHM_EMPTY, capacity);
+
+    for (size_t i = 0; i < old.capacity; i++)
+    {
+        if (old.ctrl[i] < 0)
+            continue;
+        const void *key   = lum_shm_slot_key(&old, i);
+        uint64_t    hash  = map->hash_func(key, map->key_size);
+        size_t      index = lum_shm_find_free(ctrl, capacity, hash);
+        ctrl[index]       = old.ctrl[i];
+        memcpy(lum_shm_slot_key(map, index), key, map->slot_size);
+    }
+    if (old.ctrl)
+        allocator->free(allocator, old.ctrl);
+    return true;
+}
+
+bool lum_shm_init(lum_shm_t *map, size_t key_size, size_t value_size, size_t capacity,
+                  lum_hash_func hash_func, lum_allocator *allocator)
+{
+    if (!map || !allocator || key_size == 0)
+        return false;
+
+    size_t key_align   = shm_alignment(key_size);
+    size_t value_align = shm_alignment(value_size);
+    map->ctrl          = NULL;
+    map->slots         = NULL;
+    map->capacity      = 0;
+    map->count         = 0;
+    map->growth_left   = 0;
+    map->key_size      = key_size;
+    map->value_size    = value_size;
+    map->value_offset  = lum_align_up(key_size, value_align);
+    map->slot_size     = lum_align_up(map->value_offset + value_size,
+                                      key_align > value_align ? key_align : value_align);
+    map->hash_func     = hash_func ? hash_func : lum_hash_xxhash;
+    map->allocator     = allocator;
+    return shm_rehash(map, lum_shm_capacity_for(capacity));
+}
+
+void lum_shm_destroy(lum_shm_t *map)
+{
+    if (!map || !map->ctrl)
+        return;
+    map->allocator->free(map->allocator, map->ctrl);
+    map->ctrl     = NULL;
+    map->slots    = NULL;
+    map->capacity = 0;
+    map->count    = 0;
+}
+
+bool lum_shm_reserve(lum_shm_t *map, size_t count)
+{
+    size_t capacity = lum_shm_capacity_for(count);
+    return capacity <= map->capacity || shm_rehash(map, capacity);
+}
+
+void lum_shm_clear(lum_shm_t *map)
+{
+    memset(map->ctrl, LUM_SHM_EMPTY, map->capacity);
+    map->count       = 0;
+    map->growth_left = lum_shm_growth_limit(map->capacity);
+}
+
+void *lum_shm_put(lum_shm_t *map, const void *key, const void *value)
+{
+    uint64_t hash  = map->hash_func(key, map->key_size);
+    size_t   index = lum_shm_find_hashed(map, key, hash);
+    if (index == SIZE_MAX)
+    {
+        index = lum_shm_find_free(map->ctrl, map->capacity, hash);
+        if (map->growth_left == 0 && map->ctrl[index] == LUM_SHM_EMPTY)
+        {
+            if (!shm_rehash(map, lum_shm_rehash_capacity(map->capacity, map->count)))
+                return NULL;
+            index = lum_shm_find_free(map->ctrl, map->capacity, hash);
+        }
+        if (map->ctrl[index] == LUM_SHM_EMPTY)
+            map->growth_left--;
+        map->ctrl[index] = (int8_t) (hash & 0x7F);
+        memcpy(lum_shm_slot_key(map, index), key, map->key_size);
+        map->count++;
+    }
+    void *stored = lum_shm_slot_value(map, index);
+    if (value)
+        memcpy(stored, value, map->value_size);
+    return stored;
+}
+
+bool lum_shm_remove(lum_shm_t *map, const void *key)
+{
+    size_t index = lum_shm_find_hashed(map, key, map->hash_func(key, map->key_size));
+    if (index == SIZE_MAX)
+        return false;
+    if (lum_shm_erase(map->ctrl, index))
+        map->growth_left++;
+    map->count--;
+    return true;
+}
@@ -0,0 +1,362 @@
+#ifndef LUM_CONT_SHM_H
+#define LUM_CONT_SHM_H
+
+#include "allocators/mem_alloc.h"
+#include "math/math_bits.h"
+#include "math/math_hash.h"
+#include "platform.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Open-addressing hash map in the style of Swiss tables. Keys and values of fixed size are stored
+// inline in the slots; a separate array holds one control byte per slot, either the low 7 bits of
+// the key's hash or an empty/deleted marker. Lookups scan the control bytes of a 16-slot group at
+// once and only compare keys whose fragment matches, so a miss rarely touches the slots at all.
+// Capacities are powers of two, probing moves between whole groups (triangular steps), and the
+// table grows at 7/8 load. Keys are compared with memcmp, so padding bytes must be zeroed.
+#define LUM_SHM_GROUP 16
+#define LUM_SHM_EMPTY ((int8_t) -128) // 0x80; full slots have the top bit clear
+#define LUM_SHM_DELETED ((int8_t) -2) // 0xFE, tombstone
+
+typedef struct
+{
+    int8_t        *ctrl;         // One control byte per slot, aligned to a group
+    unsigned char *slots;        // Key, then value at value_offset
+    size_t         capacity;     // Power of two, at least one group
+    size_t         count;        // Live entries
+    size_t         growth_left;  // Inserts into empty slots before the next rehash
+    size_t         key_size;
+    size_t         value_size;
+    size_t         value_offset;
+    size_t         slot_size;
+    lum_hash_func  hash_func;
+    lum_allocator *allocator;
+} lum_shm_t;
+
+// Bit i set when control byte i of the group equals `h2`
+static inline uint32_t lum_shm_group_match(const int8_t *group, int8_t h2)
+{
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_load_si128((const __m128i *) group);
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < LUM_SHM_GROUP; i++)
+        mask |= (uint32_t) (group[i] == h2) << i;
+    return mask;
+#endif
+}
+
+// Bit i set when slot i of the group is empty or deleted
+static inline uint32_t lum_shm_group_match_free(const int8_t *group)
+{
+#if defined(__SSE2__)
+    return (uint32_t) _mm_movemask_epi8(_mm_load_si128((const __m128i *) group));
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < LUM_SHM_GROUP; i++)
+        mask |= (uint32_t) (group[i] < 0) << i;
+    return mask;
+#endif
+}
+
+// Entries a table of `capacity` slots holds before it rehashes (7/8 load)
+static inline size_t lum_shm_growth_limit(size_t capacity)
+{
+    return capacity - capacity / 8;
+}
+
+static inline size_t lum_shm_capacity_for(size_t count)
+{
+    size_t capacity = LUM_SHM_GROUP;
+    while (lum_shm_growth_limit(capacity) < count)
+        capacity *= 2;
+    return capacity;
+}
+
+// Capacity to rehash into once growth runs out: mostly tombstones are cleaned up in place,
+// otherwise the table doubles
+static inline size_t lum_shm_rehash_capacity(size_t capacity, size_t count)
+{
+    return count * 2 < lum_shm_growth_limit(capacity) ? capacity : capacity * 2;
+}
+
+// First empty or deleted slot on the probe sequence of `hash`. The table never fills up, so
+// there always is one.
+static inline size_t lum_shm_find_free(const int8_t *ctrl, size_t capacity, uint64_t hash)
+{
+    size_t mask  = capacity / LUM_SHM_GROUP - 1;
+    size_t group = (size_t) (hash >> 7) & mask;
+    for (size_t step = 1;; step++)
+    {
+        uint32_t free_slots = lum_shm_group_match_free(ctrl + group * LUM_SHM_GROUP);
+        if (free_slots)
+            return group * LUM_SHM_GROUP + (size_t) lum_lsb(free_slots);
+        group = (group + step) & mask;
+    }
+}
+
+// Mark a full slot free. Probes stop at a group with an empty slot, so if this group already has
+// one nothing was ever probed past it and the slot can be emptied instead of left as a
+// tombstone. Returns true when it was emptied (the slot counts towards growth again).
+static inline bool lum_shm_erase(int8_t *ctrl, size_t index)
+{
+    bool empty   = lum_shm_group_match(ctrl + index / LUM_SHM_GROUP * LUM_SHM_GROUP,
+                                       LUM_SHM_EMPTY) != 0;
+    ctrl[index]  = empty ? LUM_SHM_EMPTY : LUM_SHM_DELETED;
+    return empty;
+}
+
+static inline void *lum_shm_slot_key(const lum_shm_t *map, size_t index)
+{
+    return map->slots + index * map->slot_size;
+}
+
+static inline void *lum_shm_slot_value(const lum_shm_t *map, size_t index)
+{
+    return map->slots + index * map->slot_size + map->value_offset;
+}
+
+// Slot index holding `key` whose hash is `hash`, or SIZE_MAX
+static inline size_t lum_shm_find_hashed(const lum_shm_t *map, const void *key, uint64_t hash)
+{
+    int8_t h2    = (int8_t) (hash & 0x7F);
+    size_t mask  = map->capacity / LUM_SHM_GROUP - 1;
+    size_t group = (size_t) (hash >> 7) & mask;
+    for (size_t step = 1; step <= mask + 1; step++)
+    {
+        const int8_t *ctrl  = map->ctrl + group * LUM_SHM_GROUP;
+        uint32_t      match = lum_shm_group_match(ctrl, h2);
+        while (match)
+        {
+            size_t index = group * LUM_SHM_GROUP + (size_t) lum_lsb(match);
+            if (memcmp(lum_shm_slot_key(map, index), key, map->key_size) == 0)
+                return index;
+            match &= match - 1;
+        }
+        // A group with an empty slot ends every probe sequence that reaches it
+        if (lum_shm_group_match(ctrl, LUM_SHM_EMPTY))
+            return SIZE_MAX;
+        group = (group + step) & mask;
+    }
+    return SIZE_MAX;
+}
+
+// `capacity` is rounded up so it holds that many entries without growing. With a NULL hash
+// function keys are hashed with xxHash.
+bool lum_shm_init(lum_shm_t *map, size_t key_size, size_t value_size, size_t capacity,
+                  lum_hash_func hash_func, lum_allocator *allocator);
+void lum_shm_destroy(lum_shm_t *map);
+// Grow so `count` entries fit without another rehash. Returns false if out of memory.
+bool lum_shm_reserve(lum_shm_t *map, size_t count);
+void lum_shm_clear(lum_shm_t *map);
+
+// Insert or overwrite; a NULL value leaves it for the caller to fill in. Returns the stored
+// value, NULL if out of memory.
+void *lum_shm_put(lum_shm_t *map, const void *key, const void *value);
+// Returns false if the key is not in the map
+bool lum_shm_remove(lum_shm_t *map, const void *key);
+
+// Pointer to the value stored for `key`, valid until the next insert, or NULL
+static inline void *lum_shm_get(const lum_shm_t *map, const void *key)
+{
+    size_t index = lum_shm_find_hashed(map, key, map->hash_func(key, map->key_size));
+    return index == SIZE_MAX ? NULL : lum_shm_slot_value(map, index);
+}
+
+// Iterate with `*it` starting at 0. Returns false once every entry has been visited.
+static inline bool lum_shm_next(const lum_shm_t *map, size_t *it, void **key, void **value)
+{
+    for (size_t index = *it; index < map->capacity; index++)
+    {
+        if (map->ctrl[index] >= 0)
+        {
+            *it = index + 1;
+            if (key)
+                *key = lum_shm_slot_key(map, index);
+            if (value)
+                *value = lum_shm_slot_value(map, index);
+            return true;
+        }
+    }
+    *it = map->capacity;
+    return false;
+}
+
+// Typed variant of lum_shm_t: LUM_HM_DECLARE(name, K, V, hash_fn, eq_fn) emits name##_t with the
+// same control bytes and probing, but slots of struct {K key; V value;} and functions taking keys
+// and values by value, so hashing and key comparison inline instead of going through a function
+// pointer and memcmp. hash_fn(K) returns a uint64_t with well mixed low bits (lum_hash_u64 for
+// integers), eq_fn(K, K) may be a function or a macro such as LUM_HM_EQ. Emitted functions:
+//   name##_init(map, capacity, allocator), name##_destroy, name##_reserve, name##_clear
+//   name##_get(map, key) -> V * or NULL, name##_put(map, key, value) -> V * or NULL if out of
+//   memory, name##_remove(map, key) -> bool, name##_next(map, &it) -> name##_slot_t * or NULL
+#define LUM_HM_EQ(a, b) ((a) == (b))
+
+#define LUM_HM_DECLARE(name, K, V, hash_fn, eq_fn)                                                 \
+    typedef struct                                                                                 \
+    {                                                                                              \
+        K key;                                                                                     \
+        V value;                                                                                   \
+    } name##_slot_t;                                                                               \
+    typedef struct                                                                                 \
+    {                                                                                              \
+        int8_t        *ctrl;                                                                       \
+        name##_slot_t *slots;                                                                      \
+        size_t         capacity;                                                                   \
+        size_t         count;                                                                      \
+        size_t         growth_left;                                                                \
+        lum_allocator *allocator;                                                                  \
+    } name##_t;                                                                                    \
+                                                                                                   \
+    static inline size_t name##_find(const name##_t *map, K key, uint64_t hash)                    \
+    {                                                                                              \
+        int8_t h2    = (int8_t) (hash & 0x7F);                                                     \
+        size_t mask  = map->capacity / LUM_SHM_GROUP - 1;                                          \
+        size_t group = (size_t) (hash >> 7) & mask;                                                \
+        for (size_t step = 1; step <= mask + 1; step++)                                            \
+        {                                                                                          \
+            const int8_t *ctrl  = map->ctrl + group * LUM_SHM_GROUP;                               \
+            uint32_t      match = lum_shm_group_match(ctrl, h2);                                   \
+            while (match)                                                                          \
+            {                                                                                      \
+                size_t index = group * LUM_SHM_GROUP + (size_t) lum_lsb(match);                    \
+                if (eq_fn(map->slots[index].key, key))                                             \
+                    return index;                                                                  \
+                match &= match - 1;                                                                \
+            }                                                                                      \
+            if (lum_shm_group_match(ctrl, LUM_SHM_EMPTY))                                          \
+                return SIZE_MAX;                                                                   \
+            group = (group + step) & mask;                                                         \
+        }                                                                                          \
+        return SIZE_MAX;                                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_rehash(name##_t *map, size_t capacity)                               \
+    {                                                                                              \
+        lum_allocator *allocator = map->allocator;                                                 \
+        int8_t        *ctrl      = allocator->alloc(allocator,                                     \
+                                                    capacity * (1 + sizeof(name##_slot_t)),        \
+                                                    LUM_SHM_GROUP);                                \
+        if (!ctrl)                                                                                 \
+            return false;                                                                          \
+                                                                                                   \
+        name##_t       old   = *map;                                                               \
+        name##_slot_t *slots = (name##_slot_t *) (ctrl + capacity);                                \
+        memset(ctrl, LUM_SHM_EMPTY, capacity);                                                     \
+        for (size_t i = 0; i < old.capacity; i++)                                                  \
+        {                                                                                          \
+            if (old.ctrl[i] < 0)                                                                   \
+                continue;                                                                          \
+            size_t index = lum_shm_find_free(ctrl, capacity, hash_fn(old.slots[i].key));           \
+            ctrl[index]  = old.ctrl[i];                                                            \
+            slots[index] = old.slots[i];                                                           \
+        }                                                                                          \
+        map->ctrl        = ctrl;                                                                   \
+        map->slots       = slots;                                                                  \
+        map->capacity    = capacity;                                                               \
+        map->growth_left = lum_shm_growth_limit(capacity) - map->count;                            \
+        if (old.ctrl)                                                                              \
+            allocator->free(allocator, old.ctrl);                                                  \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_init(name##_t *map, size_t capacity, lum_allocator *allocator)       \
+    {                                                                                              \
+        if (!map || !allocator)                                                                    \
+            return false;                                                                          \
+        map->ctrl        = NULL;                                                                   \
+        map->slots       = NULL;                                                                   \
+        map->capacity    = 0;                                                                      \
+        map->count       = 0;                                                                      \
+        map->growth_left = 0;                                                                      \
+        map->allocator   = allocator;                                                              \
+        return name##_rehash(map, lum_shm_capacity_for(capacity));                                 \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_destroy(name##_t *map)                                               \
+    {                                                                                              \
+        if (!map || !map->ctrl)                                                                    \
+            return;                                                                                \
+        map->allocator->free(map->allocator, map->ctrl);                                           \
+        map->ctrl     = NULL;                                                                      \
+        map->slots    = NULL;                                                                      \
+        map->capacity = 0;                                                                         \
+        map->count    = 0;                                                                         \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_reserve(name##_t *map, size_t count)                                 \
+    {                                                                                              \
+        size_t capacity = lum_shm_capacity_for(count);                                             \
+        return capacity <= map->capacity || name##_rehash(map, capacity);                          \
+    }                                                                                              \
+                                                                                                   \
+    static inline void name##_clear(name##_t *map)                                                 \
+    {                                                                                              \
+        memset(map->ctrl, LUM_SHM_EMPTY, map->capacity);                                           \
+        map->count       = 0;                                                                      \
+        map->growth_left = lum_shm_growth_limit(map->capacity);                                    \
+    }                                                                                              \
+                                                                                                   \
+    static inline V *name##_get(const name##_t *map, K key)                                        \
+    {                                                                                              \
+        size_t index = name##_find(map, key, hash_fn(key));                                        \
+        return index == SIZE_MAX ? NULL : &map->slots[index].value;                                \
+    }                                                                                              \
+                                                                                                   \
+    static inline V *name##_put(name##_t *map, K key, V value)                                     \
+    {                                                                                              \
+        uint64_t hash  = hash_fn(key);                                                             \
+        size_t   index = name##_find(map, key, hash);                                              \
+        if (index == SIZE_MAX)                                                                     \
+        {                                                                                          \
+            index = lum_shm_find_free(map->ctrl, map->capacity, hash);                             \
+            if (map->growth_left == 0 && map->ctrl[index] == LUM_SHM_EMPTY)                        \
+            {                                                                                      \
+                if (!name##_rehash(map, lum_shm_rehash_capacity(map->capacity, map->count)))       \
+                    return NULL;                                                                   \
+                index = lum_shm_find_free(map->ctrl, map->capacity, hash);                         \
+            }                                                                                      \
+            if (map->ctrl[index] == LUM_SHM_EMPTY)                                                 \
+                map->growth_left--;                                                                \
+            map->ctrl[index]      = (int8_t) (hash & 0x7F);                                        \
+            map->slots[index].key = key;                                                           \
+            map->count++;                                                                          \
+        }                                                                                          \
+        map->slots[index].value = value;                                                           \
+        return &map->slots[index].value;                                                           \
+    }                                                                                              \
+                                                                                                   \
+    static inline bool name##_remove(name##_t *map, K key)                                         \
+    {                                                                                              \
+        size_t index = name##_find(map, key, hash_fn(key));                                        \
+        if (index == SIZE_MAX)                                                                     \
+            return false;                                                                          \
+        if (lum_shm_erase(map->ctrl, index))                                                       \
+            map->growth_left++;                                                                    \
+        map->count--;                                                                              \
+        return true;                                                                               \
+    }                                                                                              \
+                                                                                                   \
+    static inline name##_slot_t *name##_next(const name##_t *map, size_t *it)                      \
+    {                                                                                              \
+        for (size_t index = *it; index < map->capacity; index++)                                   \
+        {                                                                                          \
+            if (map->ctrl[index] >= 0)                                                             \
+            {                                                                                      \
+                *it = index + 1;                                                                   \
+                return &map->slots[index];                                                         \
+            }                                                                                      \
+        }                                                                                          \
+        *it = map->capacity;                                                                       \
+        return NULL;                                                                               \
+    }
+
+#endif // LUM_CONT_SHM_H
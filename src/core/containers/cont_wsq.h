@@ -0,0 +1,148 @@
+#ifndef LUM_CONT_WORK_STEALING_QUEUE_H
+#define LUM_CONT_WORK_STEALING_QUEUE_H
+
+#include "allocators/mem_alloc.h"
+#include "math/math_bits.h"
+#include "platform.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Chase-Lev work-stealing deque (fixed capacity, C11 memory model version from
+// "Correct and Efficient Work-Stealing for Weak Memory Models", Le et al. 2013).
+// The owning thread pushes and pops at the bottom (LIFO), any other thread may
+// steal from the top (FIFO). Only the owner may call push/pop.
+typedef struct
+{
+    CACHE_ALIGNED atomic_llong top;    // Steal end (shared)
+    CACHE_ALIGNED atomic_llong bottom; // Owner end
+    size_t capacity;                   // Power of two
+    size_t mask;
+    _Atomic(void *) *buffer;
+    lum_allocator   *allocator;
+} lum_wsq_t;
+
+static inline bool lum_wsq_init(lum_wsq_t *queue, size_t capacity, lum_allocator *allocator)
+{
+    if (!queue || !allocator || capacity < 2)
+        return false;
+
+    if (!lum_is_power_of_two(capacity))
+        capacity = lum_next_power_of_two((uint32_t) capacity);
+
+    queue->capacity  = capacity;
+    queue->mask      = capacity - 1;
+    queue->allocator = allocator;
+    queue->buffer    = allocator->alloc(allocator, capacity * sizeof(void *), 64);
+    if (!queue->buffer)
+        return false;
+
+    for (size_t i = 0; i < capacity; i++)
+        atomic_init(&queue->buffer[i], NULL);
+    atomic_store_explicit(&queue->top, 0, memory_order_relaxed);
+    atomic_store_explicit(&queue->bottom, 0, memory_order_relaxed);
+    return true;
+}
+
+static inline void lum_wsq_destroy(lum_wsq_t *queue)
+{
+    if (!queue || !queue->buffer)
+        return;
+    queue->allocator->free(queue->allocator, (void *) queue->buffer);
+    queue->buffer = NULL;
+}
+
+// Approximate number of items (exact when called by the owner with no thieves)
+static inline size_t lum_wsq_size(lum_wsq_t *queue)
+{
+    long long b = atomic_load_explicit(&queue->bottom, memory_order_relaxed);
+    long long t = atomic_load_explicit(&queue->top, memory_order_relaxed);
+    return b > t ? (size_t) (b - t) : 0;
+}
+
+static inline bool lum_wsq_empty(lum_wsq_t *queue)
+{
+    return lum_wsq_size(queue) == 0;
+}
+
+// Owner only: push to the bottom. Returns false when full.
+static inline bool lum_wsq_push(lum_wsq_t *queue, void *item)
+{
+    long long b = atomic_load_explicit(&queue->bottom, memory_order_relaxed);
+    long long t = atomic_load_explicit(&queue->top, memory_order_acquire);
+    if (b - t > (long long) queue->mask)
+        return false; // Full
+
+    atomic_store_explicit(&queue->buffer[b & queue->mask], item, memory_order_relaxed);
+    // Release on the store itself (not a standalone fence) so thieves that acquire bottom
+    // also see the job's contents; ThreadSanitizer does not model standalone fences.
+    atomic_store_explicit(&queue->bottom, b + 1, memory_order_release);
+    return true;
+}
+
+// Owner only: push up to `count` items with a single publish of bottom.
+// Returns the number of items pushed (fewer than count when the deque fills up).
+static inline size_t lum_wsq_push_bulk(lum_wsq_t *queue, void *const *items, size_t count)
+{
+    long long b    = atomic_load_explicit(&queue->bottom, memory_order_relaxed);
+    long long t    = atomic_load_explicit(&queue->top, memory_order_acquire);
+    size_t    free = queue->capacity - (size_t) (b - t);
+    size_t    n    = count < free ? count : free;
+
+    for (size_t i = 0; i < n; i++)
+        atomic_store_explicit(&queue->buffer[(b + (long long) i) & queue->mask], items[i],
+                              memory_order_relaxed);
+    atomic_store_explicit(&queue->bottom, b + (long long) n, memory_order_release);
+    return n;
+}
+
+// Owner only: pop from the bottom. Returns NULL when empty or when the last item was stolen.
+static inline void *lum_wsq_pop(lum_wsq_t *queue)
+{
+    long long b = atomic_load_explicit(&queue->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&queue->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long t = atomic_load_explicit(&queue->top, memory_order_relaxed);
+
+    void *item = NULL;
+    if (t <= b)
+    {
+        item = atomic_load_explicit(&queue->buffer[b & queue->mask], memory_order_relaxed);
+        if (t == b)
+        {
+            // Last item: race against thieves
+            if (!atomic_compare_exchange_strong_explicit(&queue->top, &t, t + 1,
+                                                         memory_order_seq_cst,
+                                                         memory_order_relaxed))
+                item = NULL;
+            atomic_store_explicit(&queue->bottom, b + 1, memory_order_release);
+        }
+    }
+    else
+    {
+        atomic_store_explicit(&queue->bottom, b + 1, memory_order_release);
+    }
+    return item;
+}
+
+// Any thread: steal from the top. Returns NULL when empty or when the race was lost.
+static inline void *lum_wsq_steal(lum_wsq_t *queue)
+{
+    long long t = atomic_load_explicit(&queue->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long long b = atomic_load_explicit(&queue->bottom, memory_order_acquire);
+
+    if (t >= b)
+        return NULL;
+
+    void *item = atomic_load_explicit(&queue->buffer[t & queue->mask], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&queue->top, &t, t + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed))
+        return NULL;
+    return item;
+}
+
+#endif // LUM_CONT_WORK_STEALING_QUEUE_H
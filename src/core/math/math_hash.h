@@ -3,6 +3,8 @@
 
 #include "platform.h"
 
+typedef uint64_t (*lum_hash_func)(const void *key, size_t len);
+
 uint64_t lum_hash_murmur(const void *key, size_t len);
 
 // TODO: test endianness of this hash function
@@ -10,4 +12,20 @@ uint64_t lum_hash_metro(const void *key, size_t len);
 
 uint64_t lum_hash_xxhash(const void *key, size_t len);
 
+// Integer mixers for typed maps (MurmurHash3 finalizer, full avalanche)
+static inline uint64_t lum_hash_u64(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+static inline uint64_t lum_hash_u32(uint32_t x)
+{
+    return lum_hash_u64(x);
+}
+
 #endif
\ No newline at end of file
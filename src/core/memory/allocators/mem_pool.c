@@ -32,8 +32,8 @@ static void *lum_pool_allocator_alloc(lum_allocator *allocator, size_t unused_si
 
     void *obj = pool->free_list[pool->free_index];
 
-    // Mark as used in the bitmap
-    size_t index = pool->free_index;
+    // Mark the slot (not the free list position) as used in the bitmap
+    size_t index = ((char *) obj - (char *) pool->buffer) / pool->object_size;
     pool->used_slots[index / 8] |= (1 << (index % 8));
 
     pool->free_index++;
@@ -67,6 +67,14 @@ static void lum_pool_allocator_free(lum_allocator *allocator, void *ptr)
 // Initialize the pool allocator
 lum_allocator *lum_create_pool_allocator(size_t object_size, size_t object_count)
 {
+    return lum_create_pool_allocator_aligned(object_size, object_count, POOL_ALIGN);
+}
+
+lum_allocator *lum_create_pool_allocator_aligned(size_t object_size, size_t object_count,
+                                                 size_t alignment)
+{
+    if (alignment < POOL_ALIGN || !lum_is_power_of_two(alignment))
+        alignment = POOL_ALIGN;
 
     lum_allocator *allocator = lum_create_default_allocator();
     if (!allocator)
@@ -82,13 +90,13 @@ lum_allocator *lum_create_pool_allocator(size_t object_size, size_t object_count
     }
 
     // Ensure object size is properly aligned
-    pool->object_size = lum_align_up(object_size, POOL_ALIGN);
+    pool->object_size = lum_align_up(object_size, alignment);
 
     // Initialize each pointer.
     pool->buffer     = NULL;
     pool->free_list  = NULL;
     pool->used_slots = NULL;
-    pool->buffer = allocator->alloc(allocator, pool->object_size * object_count, _Alignof(size_t));
+    pool->buffer = allocator->alloc(allocator, pool->object_size * object_count, alignment);
     if (!pool->buffer)
     {
         printf("Failed to pool buffer from default allocator\n");
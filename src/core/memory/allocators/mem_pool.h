@@ -19,6 +19,9 @@ typedef struct
 } lum_pool_allocator;
 
 lum_allocator *lum_create_pool_allocator(size_t object_size, size_t object_count);
+// Same as above with every object aligned to `alignment` (power of two, e.g. a cache line)
+lum_allocator *lum_create_pool_allocator_aligned(size_t object_size, size_t object_count,
+                                                 size_t alignment);
 void           lum_pool_allocator_destroy(lum_allocator *allocator);
 
 #endif // LUM_MEM_POOL_H
@@ -45,6 +45,22 @@ void lum_stack_reset(lum_allocator *self)
     stack->prev_offset         = 0;
 }
 
+size_t lum_stack_mark(lum_allocator *self)
+{
+    lum_stack_allocator *stack = (lum_stack_allocator *) self->user_data;
+    return stack->offset;
+}
+
+void lum_stack_rewind(lum_allocator *self, size_t mark)
+{
+    lum_stack_allocator *stack = (lum_stack_allocator *) self->user_data;
+    if (mark <= stack->offset)
+    {
+        stack->offset      = mark;
+        stack->prev_offset = mark;
+    }
+}
+
 // Create a stack allocator
 lum_allocator *lum_create_stack_allocator(size_t size)
 {
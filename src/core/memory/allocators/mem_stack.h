@@ -26,6 +26,12 @@ void lum_stack_pop(lum_allocator *self, void *ptr);
 // Reset the stack (clear all allocations)
 void lum_stack_reset(lum_allocator *self);
 
+// Current top of the stack, to rewind to later
+size_t lum_stack_mark(lum_allocator *self);
+
+// Free everything allocated since the mark was taken
+void lum_stack_rewind(lum_allocator *self, size_t mark);
+
 // Destroy the stack allocator
 void lum_destroy_stack_allocator(lum_allocator *self);
 
@@ -20,6 +20,9 @@
 #endif
 
 // --------------- Threading ------------------- //
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef PLATFORM_WINDOWS
 #include <windows.h>
 typedef HANDLE            lum_thread;
@@ -31,6 +34,10 @@ typedef ConditionVariable lum_cond_var;
 #include <sched.h>
 #include <unistd.h> // POSIX usleep
 #include <stdint.h>
+#ifdef PLATFORM_LINUX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
 typedef pthread_t       lum_thread;
 typedef int             lum_thread_id;
 typedef pthread_mutex_t lum_mutex;
@@ -64,6 +71,22 @@ static inline void lum_thread_yield(void)
 #endif
 }
 
+/**
+ * @brief CPU hint for spin-wait loops (x86 PAUSE / ARM YIELD).
+ */
+static inline void lum_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef PLATFORM_WINDOWS
+    YieldProcessor();
+#else
+    __builtin_ia32_pause();
+#endif
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
 // Thread function type
 typedef void *(*lum_thread_func)(void *);
 
@@ -153,6 +176,15 @@ static inline void lum_mutex_lock(lum_mutex *mutex)
 #endif
 }
 
+static inline bool lum_mutex_trylock(lum_mutex *mutex)
+{
+#ifdef PLATFORM_WINDOWS
+    return TryEnterCriticalSection(mutex) != 0;
+#else
+    return pthread_mutex_trylock(mutex) == 0;
+#endif
+}
+
 static inline void lum_mutex_unlock(lum_mutex *mutex)
 {
 #ifdef PLATFORM_WINDOWS
@@ -171,6 +203,192 @@ static inline void lum_mutex_destroy(lum_mutex *mutex)
 #endif
 }
 
+// ----------------- Time ---------------------- //
+#ifndef PLATFORM_WINDOWS
+#include <time.h>
+#endif
+
+// Monotonic clock in nanoseconds
+static inline uint64_t lum_time_now_ns(void)
+{
+#ifdef PLATFORM_WINDOWS
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER        counter;
+    if (frequency.QuadPart == 0)
+        QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t) (counter.QuadPart / frequency.QuadPart * 1000000000ull +
+                       counter.QuadPart % frequency.QuadPart * 1000000000ull / frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ull + (uint64_t) ts.tv_nsec;
+#endif
+}
+// --------------- End Time -------------------- //
+
+// --------------- Futex / Eventcount ------------------- //
+#include <stdatomic.h>
+#include <stdint.h>
+
+#ifdef PLATFORM_WINDOWS
+#pragma comment(lib, "Synchronization.lib")
+#elif defined(PLATFORM_MACOS)
+// libc++ uses the same private entry points for std::atomic::wait
+extern int __ulock_wait(uint32_t operation, void *addr, uint64_t value, uint32_t timeout);
+extern int __ulock_wake(uint32_t operation, void *addr, uint64_t wake_value);
+#define LUM_UL_COMPARE_AND_WAIT 1
+#define LUM_ULF_WAKE_ALL 0x00000100
+#endif
+
+/**
+ * @brief Block while *addr == expected (may return spuriously).
+ */
+static inline void lum_futex_wait(atomic_uint *addr, uint32_t expected)
+{
+#ifdef PLATFORM_WINDOWS
+    WaitOnAddress((volatile VOID *) addr, &expected, sizeof(expected), INFINITE);
+#elif defined(PLATFORM_LINUX)
+    syscall(SYS_futex, (void *) addr, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+#else
+    __ulock_wait(LUM_UL_COMPARE_AND_WAIT, (void *) addr, expected, 0);
+#endif
+}
+
+/**
+ * @brief lum_futex_wait that gives up after timeout_ns (rounded up to the platform's unit).
+ */
+static inline void lum_futex_wait_timeout(atomic_uint *addr, uint32_t expected, uint64_t timeout_ns)
+{
+#ifdef PLATFORM_WINDOWS
+    DWORD ms = (DWORD) ((timeout_ns + 999999) / 1000000);
+    WaitOnAddress((volatile VOID *) addr, &expected, sizeof(expected), ms ? ms : 1);
+#elif defined(PLATFORM_LINUX)
+    struct timespec timeout = {(time_t) (timeout_ns / 1000000000ull),
+                               (long) (timeout_ns % 1000000000ull)};
+    syscall(SYS_futex, (void *) addr, FUTEX_WAIT_PRIVATE, expected, &timeout, NULL, 0);
+#else
+    uint64_t us = (timeout_ns + 999) / 1000;
+    __ulock_wait(LUM_UL_COMPARE_AND_WAIT, (void *) addr, expected,
+                 (uint32_t) (us == 0 ? 1 : (us > UINT32_MAX ? UINT32_MAX : us)));
+#endif
+}
+
+/**
+ * @brief Wake up to `count` threads blocked in lum_futex_wait on addr.
+ */
+static inline void lum_futex_wake(atomic_uint *addr, int count)
+{
+#ifdef PLATFORM_WINDOWS
+    if (count == INT32_MAX)
+        WakeByAddressAll((PVOID) addr);
+    else
+        for (int i = 0; i < count; i++)
+            WakeByAddressSingle((PVOID) addr);
+#elif defined(PLATFORM_LINUX)
+    syscall(SYS_futex, (void *) addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+#else
+    if (count == 1)
+        __ulock_wake(LUM_UL_COMPARE_AND_WAIT, (void *) addr, 0);
+    else
+        __ulock_wake(LUM_UL_COMPARE_AND_WAIT | LUM_ULF_WAKE_ALL, (void *) addr, 0);
+#endif
+}
+
+static inline void lum_futex_wake_one(atomic_uint *addr)
+{
+    lum_futex_wake(addr, 1);
+}
+
+static inline void lum_futex_wake_all(atomic_uint *addr)
+{
+    lum_futex_wake(addr, INT32_MAX);
+}
+
+// Eventcount: lets a thread sleep on an arbitrary predicate without a mutex. Notifiers only
+// touch the kernel when a waiter is registered.
+//
+//   uint32_t key = lum_eventcount_prepare_wait(&ec);
+//   if (predicate()) lum_eventcount_cancel_wait(&ec);
+//   else             lum_eventcount_commit_wait(&ec, key);
+//
+// Notifiers make the predicate true, then call lum_eventcount_notify_*.
+typedef struct
+{
+    atomic_uint epoch;   // Bumped by notifiers, waiters sleep on it
+    atomic_int  waiters; // Threads between prepare and commit/cancel
+} lum_eventcount;
+
+static inline void lum_eventcount_init(lum_eventcount *ec)
+{
+    atomic_init(&ec->epoch, 0);
+    atomic_init(&ec->waiters, 0);
+}
+
+static inline uint32_t lum_eventcount_prepare_wait(lum_eventcount *ec)
+{
+    atomic_fetch_add_explicit(&ec->waiters, 1, memory_order_seq_cst);
+    uint32_t key = atomic_load_explicit(&ec->epoch, memory_order_seq_cst);
+    // Order the registration before the caller's predicate check
+    atomic_thread_fence(memory_order_seq_cst);
+    return key;
+}
+
+static inline void lum_eventcount_cancel_wait(lum_eventcount *ec)
+{
+    atomic_fetch_sub_explicit(&ec->waiters, 1, memory_order_relaxed);
+}
+
+static inline void lum_eventcount_commit_wait(lum_eventcount *ec, uint32_t key)
+{
+    while (atomic_load_explicit(&ec->epoch, memory_order_acquire) == key)
+        lum_futex_wait(&ec->epoch, key);
+    atomic_fetch_sub_explicit(&ec->waiters, 1, memory_order_relaxed);
+}
+
+// commit_wait that returns after timeout_ns even if nobody notified
+static inline void lum_eventcount_commit_wait_timeout(lum_eventcount *ec, uint32_t key,
+                                                     uint64_t timeout_ns)
+{
+    uint64_t deadline = lum_time_now_ns() + timeout_ns;
+    uint64_t now;
+    while (atomic_load_explicit(&ec->epoch, memory_order_acquire) == key &&
+           (now = lum_time_now_ns()) < deadline)
+        lum_futex_wait_timeout(&ec->epoch, key, deadline - now);
+    atomic_fetch_sub_explicit(&ec->waiters, 1, memory_order_relaxed);
+}
+
+static inline void lum_eventcount_notify_one(lum_eventcount *ec)
+{
+    // Order the caller's predicate update before the waiter check
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ec->waiters, memory_order_relaxed) == 0)
+        return;
+    atomic_fetch_add_explicit(&ec->epoch, 1, memory_order_release);
+    lum_futex_wake_one(&ec->epoch);
+}
+
+// Wake at most `count` waiters (the kernel caps it at the number actually asleep)
+static inline void lum_eventcount_notify_n(lum_eventcount *ec, int count)
+{
+    if (count <= 0)
+        return;
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ec->waiters, memory_order_relaxed) == 0)
+        return;
+    atomic_fetch_add_explicit(&ec->epoch, 1, memory_order_release);
+    lum_futex_wake(&ec->epoch, count);
+}
+
+static inline void lum_eventcount_notify_all(lum_eventcount *ec)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&ec->waiters, memory_order_relaxed) == 0)
+        return;
+    atomic_fetch_add_explicit(&ec->epoch, 1, memory_order_release);
+    lum_futex_wake_all(&ec->epoch);
+}
+
 #if defined(PLATFORM_WINDOWS)
 #define THREAD_LOCAL __declspec(thread)
 #elif defined(PLATFORM_MACOS) || defined(PLATFORM_LINUX)
@@ -179,6 +397,13 @@ static inline void lum_mutex_destroy(lum_mutex *mutex)
 #error "Compiler does not support thread-local storage"
 #endif
 
+// Keeps TLS reads from being cached across fiber switches (a fiber may resume on another thread)
+#if defined(PLATFORM_WINDOWS)
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
 // --------------- End Threading ------------------- //
 
 // ---------------- Memory --------------------- //
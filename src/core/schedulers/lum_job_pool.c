@@ -0,0 +1,132 @@
+#include "lum_job_pool.h"
+
+#include "../memory/allocators/mem_alloc.h"
+#include "../memory/allocators/mem_pool.h"
+
+#include <stdint.h>
+
+#define JOB_POOL_ALIGN 64
+
+bool lum_job_pool_init(lum_job_pool_t *pool, size_t capacity, lum_allocator *fallback)
+{
+    if (!pool || !fallback || capacity == 0)
+        return false;
+
+    pool->pool = lum_create_pool_allocator_aligned(sizeof(Job), capacity, JOB_POOL_ALIGN);
+    if (!pool->pool)
+        return false;
+
+    pool->fallback    = fallback;
+    pool->batch_head  = NULL;
+    pool->batch_tail  = NULL;
+    pool->batch_count = 0;
+    pool->batch_owner = NULL;
+    atomic_init(&pool->remote_free, NULL);
+    return true;
+}
+
+void lum_job_pool_destroy(lum_job_pool_t *pool)
+{
+    if (!pool || !pool->pool)
+        return;
+    // Jobs parked in remote lists live inside the pool buffer and go away with it
+    lum_pool_allocator_destroy(pool->pool);
+    pool->pool = NULL;
+}
+
+// Push a chain [head, tail] onto the owner's remote free list with one CAS
+static void job_pool_push_remote(lum_job_pool_t *owner, Job *head, Job *tail)
+{
+    Job *top = atomic_load_explicit(&owner->remote_free, memory_order_relaxed);
+    do
+    {
+        tail->next = top;
+    } while (!atomic_compare_exchange_weak_explicit(&owner->remote_free, &top, head,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+// Take everything other threads returned. Only the owner pops, so there is no ABA.
+static void job_pool_drain_remote(lum_job_pool_t *pool)
+{
+    Job *job = atomic_exchange_explicit(&pool->remote_free, NULL, memory_order_acquire);
+    while (job)
+    {
+        Job *next = job->next;
+        pool->pool->free(pool->pool, job);
+        job = next;
+    }
+}
+
+Job *lum_job_pool_alloc(lum_job_pool_t *pool)
+{
+    Job *job = pool->pool->alloc(pool->pool, sizeof(Job), JOB_POOL_ALIGN);
+    if (!job && atomic_load_explicit(&pool->remote_free, memory_order_relaxed))
+    {
+        job_pool_drain_remote(pool);
+        job = pool->pool->alloc(pool->pool, sizeof(Job), JOB_POOL_ALIGN);
+    }
+
+    if (job)
+    {
+        job->flags = 0;
+    }
+    else
+    {
+        job = pool->fallback->alloc(pool->fallback, sizeof(Job), JOB_POOL_ALIGN);
+        if (!job)
+            return NULL;
+        job->flags = LUM_JOB_FLAG_HEAP;
+    }
+    job->pool = pool;
+    job->next = NULL;
+    return job;
+}
+
+void lum_job_pool_flush(lum_job_pool_t *local)
+{
+    if (!local || !local->batch_head)
+        return;
+    job_pool_push_remote(local->batch_owner, local->batch_head, local->batch_tail);
+    local->batch_head  = NULL;
+    local->batch_tail  = NULL;
+    local->batch_count = 0;
+    local->batch_owner = NULL;
+}
+
+void lum_job_pool_free(lum_job_pool_t *local, Job *job)
+{
+    if (!job)
+        return;
+
+    lum_job_pool_t *owner = job->pool;
+    if (job->flags & LUM_JOB_FLAG_HEAP)
+    {
+        owner->fallback->free(owner->fallback, job);
+        return;
+    }
+
+    if (owner == local)
+    {
+        local->pool->free(local->pool, job);
+        return;
+    }
+
+    if (!local)
+    {
+        job->next = NULL;
+        job_pool_push_remote(owner, job, job);
+        return;
+    }
+
+    // Batch frees per owner so the owner's list is touched once every LUM_JOB_POOL_BATCH jobs
+    if (local->batch_owner != owner)
+        lum_job_pool_flush(local);
+
+    job->next = local->batch_head;
+    if (!local->batch_head)
+        local->batch_tail = job;
+    local->batch_head  = job;
+    local->batch_owner = owner;
+    if (++local->batch_count >= LUM_JOB_POOL_BATCH)
+        lum_job_pool_flush(local);
+}
@@ -0,0 +1,40 @@
+#ifndef LUM_JOB_POOL_H
+#define LUM_JOB_POOL_H
+
+#include "platform.h"
+#include "threads/lum_thread.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define LUM_JOB_POOL_BATCH 32 // Cross-thread frees handed back per atomic push
+
+// Thread-local job pool. The owner allocates and frees without synchronisation through a
+// cache-line aligned mem_pool; other threads return jobs in batches to `remote_free`, which the
+// owner drains once its pool runs dry. When both are empty the fallback allocator is used.
+struct lum_job_pool
+{
+    lum_allocator  *pool;        // mem_pool backing store, owner only
+    lum_allocator  *fallback;    // Thread-safe allocator used when the pool is exhausted
+    _Atomic(Job *)  remote_free; // Jobs returned by other threads
+    CACHE_ALIGNED Job *batch_head; // Pending frees for batch_owner (owner only)
+    Job            *batch_tail;
+    size_t          batch_count;
+    lum_job_pool_t *batch_owner;
+} CACHE_ALIGNED;
+
+bool lum_job_pool_init(lum_job_pool_t *pool, size_t capacity, lum_allocator *fallback);
+void lum_job_pool_destroy(lum_job_pool_t *pool);
+
+// Owner thread only
+Job *lum_job_pool_alloc(lum_job_pool_t *pool);
+
+// Return a job to its owning pool. `local` is the calling thread's pool, or NULL on threads
+// without one (the job is then handed back to its owner immediately).
+void lum_job_pool_free(lum_job_pool_t *local, Job *job);
+
+// Hand any pending cross-thread frees back to their owner.
+void lum_job_pool_flush(lum_job_pool_t *local);
+
+#endif // LUM_JOB_POOL_H
@@ -0,0 +1,254 @@
+#include "lum_parallel.h"
+
+#include "../memory/allocators/mem_alloc.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define PARALLEL_CHUNKS_PER_THREAD 8  // Automatic grain: enough chunks to balance uneven work
+#define PARALLEL_PENDING_PER_THREAD 4 // Split jobs queued at once per worker
+
+typedef struct lum_parallel_task lum_parallel_task_t;
+
+// Runs one chunk [begin, end) with index `chunk`
+typedef void (*parallel_chunk_func)(lum_parallel_task_t *task, size_t chunk, size_t begin,
+                                    size_t end);
+
+// Shared by every job of one parallel call; lives on the calling thread's stack
+struct lum_parallel_task
+{
+    lum_scheduler_t          *scheduler;
+    parallel_chunk_func       run_chunk;
+    size_t                    begin;
+    size_t                    end;
+    size_t                    grain;
+    int                       max_pending; // Stop splitting while this many jobs are queued
+    lum_counter_t             counter;     // Split jobs still running
+    lum_parallel_for_func     for_fn;
+    lum_parallel_reduce_func  reduce_fn;
+    lum_parallel_combine_func combine;
+    void                     *ctx;
+    const void               *identity;
+    unsigned char            *values; // Reduce partials / scan chunk totals, one per chunk
+    size_t                    value_size;
+    const unsigned char      *input;
+    unsigned char            *output;
+};
+
+// Range of chunk indices [first, last), stored inline in the job
+typedef struct
+{
+    lum_parallel_task_t *task;
+    size_t               first;
+    size_t               last;
+} parallel_range_t;
+
+static void *parallel_range_job(void *arg);
+
+// Hand out upper halves until one chunk is left, then run what remains. Splitting is lazy:
+// with enough jobs already pending the rest runs here, which keeps helpers that pull from the
+// FIFO shared queue from expanding the whole split tree breadth first.
+static void parallel_split(lum_parallel_task_t *t, size_t first, size_t last)
+{
+    while (last - first > 1 &&
+           atomic_load_explicit(&t->counter.value, memory_order_relaxed) < t->max_pending)
+    {
+        size_t           mid   = first + (last - first) / 2;
+        parallel_range_t upper = {t, mid, last};
+        Job *job = lum_scheduler_create_job_inline(t->scheduler, parallel_range_job, &upper,
+                                                   sizeof(upper));
+        if (!job)
+            break; // Out of jobs: run the rest on this thread
+        lum_scheduler_submit_counted(t->scheduler, job, &t->counter);
+        last = mid;
+    }
+
+    for (size_t chunk = first; chunk < last; chunk++)
+    {
+        size_t begin = t->begin + chunk * t->grain;
+        size_t end   = t->end - begin > t->grain ? begin + t->grain : t->end;
+        t->run_chunk(t, chunk, begin, end);
+    }
+}
+
+static void *parallel_range_job(void *arg)
+{
+    parallel_range_t *range = (parallel_range_t *) arg;
+    parallel_split(range->task, range->first, range->last);
+    return NULL;
+}
+
+static size_t parallel_chunk_count(lum_parallel_task_t *t)
+{
+    return (t->end - t->begin + t->grain - 1) / t->grain;
+}
+
+static void parallel_run(lum_parallel_task_t *t)
+{
+    lum_counter_init(&t->counter);
+    parallel_split(t, 0, parallel_chunk_count(t));
+    // Runs the remaining chunks here, then parks (or suspends the fiber) for the stragglers
+    lum_scheduler_wait_counter_helping(t->scheduler, &t->counter);
+}
+
+static void parallel_task_init(lum_parallel_task_t *t, lum_scheduler_t *scheduler, size_t begin,
+                               size_t end, size_t grain)
+{
+    memset(t, 0, sizeof(*t));
+    t->scheduler = scheduler;
+    t->begin     = begin;
+    t->end       = end;
+    if (grain == 0)
+    {
+        size_t chunks = scheduler->config->num_threads * PARALLEL_CHUNKS_PER_THREAD;
+        grain         = (end - begin + chunks - 1) / chunks;
+    }
+    t->grain = grain > 0 ? grain : 1;
+
+    size_t max_pending = scheduler->config->num_threads * PARALLEL_PENDING_PER_THREAD;
+    if (max_pending > scheduler->config->queue_capacity / 4)
+        max_pending = scheduler->config->queue_capacity / 4;
+    t->max_pending = max_pending > 0 ? (int) max_pending : 1;
+}
+
+static void parallel_for_chunk(lum_parallel_task_t *t, size_t chunk, size_t begin, size_t end)
+{
+    (void) chunk;
+    t->for_fn(begin, end, t->ctx);
+}
+
+void lum_parallel_for(lum_scheduler_t *scheduler, size_t begin, size_t end, size_t grain,
+                      lum_parallel_for_func fn, void *ctx)
+{
+    if (!scheduler || !fn || begin >= end)
+        return;
+
+    lum_parallel_task_t task;
+    parallel_task_init(&task, scheduler, begin, end, grain);
+    task.run_chunk = parallel_for_chunk;
+    task.for_fn    = fn;
+    task.ctx       = ctx;
+    parallel_run(&task);
+}
+
+static void parallel_reduce_chunk(lum_parallel_task_t *t, size_t chunk, size_t begin, size_t end)
+{
+    void *partial = t->values + chunk * t->value_size;
+    memcpy(partial, t->identity, t->value_size);
+    t->reduce_fn(begin, end, partial, t->ctx);
+}
+
+bool lum_parallel_reduce(lum_scheduler_t *scheduler, size_t begin, size_t end, size_t grain,
+                         void *result, const void *identity, size_t value_size,
+                         lum_parallel_reduce_func fn, lum_parallel_combine_func combine,
+                         void *ctx)
+{
+    assert(value_size <= LUM_PARALLEL_MAX_VALUE_SIZE);
+    memcpy(result, identity, value_size);
+    if (!scheduler || !fn || !combine || begin >= end)
+        return true;
+
+    lum_parallel_task_t task;
+    parallel_task_init(&task, scheduler, begin, end, grain);
+    task.run_chunk  = parallel_reduce_chunk;
+    task.reduce_fn  = fn;
+    task.combine    = combine;
+    task.ctx        = ctx;
+    task.identity   = identity;
+    task.value_size = value_size;
+
+    // One partial per chunk, allocated once for the whole call
+    lum_allocator *allocator = scheduler->config->allocator;
+    size_t         chunks    = parallel_chunk_count(&task);
+    task.values              = allocator->alloc(allocator, chunks * value_size, 16);
+    if (!task.values)
+        return false;
+
+    parallel_run(&task);
+    for (size_t i = 0; i < chunks; i++)
+        combine(result, task.values + i * value_size, ctx);
+
+    allocator->free(allocator, task.values);
+    return true;
+}
+
+// Pass 1: scan the chunk on its own and record its total
+static void parallel_scan_chunk(lum_parallel_task_t *t, size_t chunk, size_t begin, size_t end)
+{
+    size_t         size = t->value_size;
+    unsigned char  accum[LUM_PARALLEL_MAX_VALUE_SIZE];
+    unsigned char *out = t->output + begin * size;
+
+    memcpy(accum, t->input + begin * size, size);
+    memcpy(out, accum, size);
+    for (size_t i = begin + 1; i < end; i++)
+    {
+        out += size;
+        t->combine(accum, t->input + i * size, t->ctx); // Read before out overwrites an alias
+        memcpy(out, accum, size);
+    }
+    memcpy(t->values + chunk * size, accum, size);
+}
+
+// Pass 2: prepend the total of all earlier chunks
+static void parallel_scan_offset_chunk(lum_parallel_task_t *t, size_t chunk, size_t begin,
+                                       size_t end)
+{
+    if (chunk == 0)
+        return;
+
+    size_t               size   = t->value_size;
+    const unsigned char *offset = t->values + (chunk - 1) * size;
+    unsigned char        value[LUM_PARALLEL_MAX_VALUE_SIZE];
+    for (size_t i = begin; i < end; i++)
+    {
+        unsigned char *out = t->output + i * size;
+        memcpy(value, offset, size);
+        t->combine(value, out, t->ctx);
+        memcpy(out, value, size);
+    }
+}
+
+bool lum_parallel_scan(lum_scheduler_t *scheduler, const void *input, void *output, size_t count,
+                       size_t value_size, size_t grain, lum_parallel_combine_func combine,
+                       void *ctx)
+{
+    assert(value_size <= LUM_PARALLEL_MAX_VALUE_SIZE);
+    if (!scheduler || !input || !output || !combine || count == 0)
+        return true;
+
+    lum_parallel_task_t task;
+    parallel_task_init(&task, scheduler, 0, count, grain);
+    task.run_chunk  = parallel_scan_chunk;
+    task.combine    = combine;
+    task.ctx        = ctx;
+    task.value_size = value_size;
+    task.input      = input;
+    task.output     = output;
+
+    lum_allocator *allocator = scheduler->config->allocator;
+    size_t         chunks    = parallel_chunk_count(&task);
+    task.values              = allocator->alloc(allocator, chunks * value_size, 16);
+    if (!task.values)
+        return false;
+
+    parallel_run(&task);
+
+    // Chunk totals become running totals (few enough to do serially)
+    unsigned char value[LUM_PARALLEL_MAX_VALUE_SIZE];
+    for (size_t i = 1; i < chunks; i++)
+    {
+        memcpy(value, task.values + (i - 1) * value_size, value_size);
+        combine(value, task.values + i * value_size, ctx);
+        memcpy(task.values + i * value_size, value, value_size);
+    }
+
+    if (chunks > 1)
+    {
+        task.run_chunk = parallel_scan_offset_chunk;
+        parallel_run(&task);
+    }
+
+    allocator->free(allocator, task.values);
+    return true;
+}
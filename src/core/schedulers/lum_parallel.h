@@ -0,0 +1,71 @@
+#ifndef LUM_PARALLEL_H
+#define LUM_PARALLEL_H
+
+#include "lum_scheduler.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LUM_PARALLEL_MAX_VALUE_SIZE 64 // Largest reduce/scan element in bytes
+
+// Key + payload pairs sorted by the radix sorts
+typedef struct
+{
+    uint32_t key;
+    uint32_t value;
+} lum_sort_pair32_t;
+
+typedef struct
+{
+    uint64_t key;
+    uint64_t value;
+} lum_sort_pair64_t;
+
+// Loop body over [begin, end)
+typedef void (*lum_parallel_for_func)(size_t begin, size_t end, void *ctx);
+// qsort-style ordering of two elements
+typedef int (*lum_sort_compare_func)(const void *a, const void *b, void *ctx);
+// Accumulate [begin, end) into *partial, which starts out as the identity
+typedef void (*lum_parallel_reduce_func)(size_t begin, size_t end, void *partial, void *ctx);
+// *accum = *accum op *value, for an associative op
+typedef void (*lum_parallel_combine_func)(void *accum, const void *value, void *ctx);
+
+// Run fn over [begin, end) in chunks of `grain` iterations (0 picks a grain from the worker
+// count). The range is split by recursive halving: every job pushes its upper half back onto the
+// scheduler and keeps the lower half until a single chunk is left, so nothing is allocated per
+// iteration. The calling thread runs chunks too and returns once all of them have finished.
+void lum_parallel_for(lum_scheduler_t *scheduler, size_t begin, size_t end, size_t grain,
+                      lum_parallel_for_func fn, void *ctx);
+
+// Reduce [begin, end) into *result (value_size bytes). Chunk partials are combined in index
+// order, so combine does not need to be commutative. Returns false if out of memory.
+bool lum_parallel_reduce(lum_scheduler_t *scheduler, size_t begin, size_t end, size_t grain,
+                         void *result, const void *identity, size_t value_size,
+                         lum_parallel_reduce_func fn, lum_parallel_combine_func combine,
+                         void *ctx);
+
+// Inclusive scan: output[i] = input[0] op ... op input[i] over `count` elements of value_size
+// bytes. output may alias input. Returns false if out of memory.
+bool lum_parallel_scan(lum_scheduler_t *scheduler, const void *input, void *output, size_t count,
+                       size_t value_size, size_t grain, lum_parallel_combine_func combine,
+                       void *ctx);
+
+// Stable LSD radix sort of `count` pairs by key, 8 bits per pass. Each pass counts digits into
+// one histogram per block of pairs, prefix-sums them serially, then scatters the blocks in
+// parallel; passes whose digit is the same for every key are skipped. `scratch` must hold
+// `count` pairs, or be NULL to borrow them from the scheduler's allocator. Returns false if out of
+// memory.
+bool lum_parallel_radix_sort32(lum_scheduler_t *scheduler, lum_sort_pair32_t *pairs,
+                               lum_sort_pair32_t *scratch, size_t count);
+bool lum_parallel_radix_sort64(lum_scheduler_t *scheduler, lum_sort_pair64_t *pairs,
+                               lum_sort_pair64_t *scratch, size_t count);
+
+// Stable merge sort of `count` elements of `size` bytes. Blocks are sorted in parallel, then
+// merged pairwise; every merge round is split evenly over the output (merge path), so the last
+// rounds stay parallel too. Needs count * size bytes of scratch from the scheduler's allocator.
+// Returns false if out of memory.
+bool lum_parallel_merge_sort(lum_scheduler_t *scheduler, void *base, size_t count, size_t size,
+                             lum_sort_compare_func compare, void *ctx);
+
+#endif // LUM_PARALLEL_H
@@ -0,0 +1,377 @@
+#include "lum_parallel.h"
+
+#include "../memory/allocators/mem_alloc.h"
+
+#include <string.h>
+
+#define SORT_RADIX_BITS 8
+#define SORT_RADIX_SIZE (1u << SORT_RADIX_BITS)
+#define SORT_BLOCKS_PER_THREAD 4 // Blocks (radix) and merge segments per worker
+#define SORT_MIN_BLOCK 4096      // Smaller blocks cost more in jobs than they save
+#define SORT_INSERTION_RUN 32    // Merge sort: runs this short are insertion sorted
+
+// Work items: ranges of `count` elements split into blocks of `block_size`
+static size_t sort_block_size(lum_scheduler_t *scheduler, size_t count)
+{
+    size_t blocks    = scheduler->config->num_threads * SORT_BLOCKS_PER_THREAD;
+    size_t max_block = (count + SORT_MIN_BLOCK - 1) / SORT_MIN_BLOCK;
+    if (blocks > max_block)
+        blocks = max_block;
+    if (blocks == 0)
+        blocks = 1;
+    return (count + blocks - 1) / blocks;
+}
+
+// Run fn over block indices [0, blocks), one block per chunk
+static void sort_for_blocks(lum_scheduler_t *scheduler, size_t blocks, lum_parallel_for_func fn,
+                            void *ctx)
+{
+    if (blocks == 1)
+        fn(0, 1, ctx); // Not worth a job
+    else
+        lum_parallel_for(scheduler, 0, blocks, 1, fn, ctx);
+}
+
+// ---------------- Radix sort --------------------- //
+
+typedef struct
+{
+    const void *src;
+    void       *dst;
+    size_t      count;
+    size_t      block_size;
+    bool        wide;  // lum_sort_pair64_t, else lum_sort_pair32_t
+    unsigned    shift; // Digit of this pass
+    size_t (*histograms)[SORT_RADIX_SIZE]; // Counts per block, then its scatter offsets
+} sort_radix_t;
+
+static void sort_radix_histogram(size_t begin, size_t end, void *ctx)
+{
+    sort_radix_t *r = (sort_radix_t *) ctx;
+    for (size_t block = begin; block < end; block++)
+    {
+        size_t *histogram = r->histograms[block];
+        size_t  lo        = block * r->block_size;
+        size_t  hi        = r->count - lo > r->block_size ? lo + r->block_size : r->count;
+        memset(histogram, 0, sizeof(r->histograms[0]));
+        if (r->wide)
+        {
+            const lum_sort_pair64_t *src = (const lum_sort_pair64_t *) r->src;
+            for (size_t i = lo; i < hi; i++)
+                histogram[(src[i].key >> r->shift) & (SORT_RADIX_SIZE - 1)]++;
+        }
+        else
+        {
+            const lum_sort_pair32_t *src = (const lum_sort_pair32_t *) r->src;
+            for (size_t i = lo; i < hi; i++)
+                histogram[(src[i].key >> r->shift) & (SORT_RADIX_SIZE - 1)]++;
+        }
+    }
+}
+
+static void sort_radix_scatter(size_t begin, size_t end, void *ctx)
+{
+    sort_radix_t *r = (sort_radix_t *) ctx;
+    for (size_t block = begin; block < end; block++)
+    {
+        size_t *offset = r->histograms[block];
+        size_t  lo     = block * r->block_size;
+        size_t  hi     = r->count - lo > r->block_size ? lo + r->block_size : r->count;
+        if (r->wide)
+        {
+            const lum_sort_pair64_t *src = (const lum_sort_pair64_t *) r->src;
+            lum_sort_pair64_t       *dst = (lum_sort_pair64_t *) r->dst;
+            for (size_t i = lo; i < hi; i++)
+                dst[offset[(src[i].key >> r->shift) & (SORT_RADIX_SIZE - 1)]++] = src[i];
+        }
+        else
+        {
+            const lum_sort_pair32_t *src = (const lum_sort_pair32_t *) r->src;
+            lum_sort_pair32_t       *dst = (lum_sort_pair32_t *) r->dst;
+            for (size_t i = lo; i < hi; i++)
+                dst[offset[(src[i].key >> r->shift) & (SORT_RADIX_SIZE - 1)]++] = src[i];
+        }
+    }
+}
+
+static void sort_radix_copy_back(size_t begin, size_t end, void *ctx)
+{
+    sort_radix_t *r    = (sort_radix_t *) ctx;
+    size_t        size = r->wide ? sizeof(lum_sort_pair64_t) : sizeof(lum_sort_pair32_t);
+    for (size_t block = begin; block < end; block++)
+    {
+        size_t lo = block * r->block_size;
+        size_t hi = r->count - lo > r->block_size ? lo + r->block_size : r->count;
+        memcpy((unsigned char *) r->dst + lo * size, (const unsigned char *) r->src + lo * size,
+               (hi - lo) * size);
+    }
+}
+
+// Turn block counts into scatter offsets: digits in order, blocks in order within a digit, which
+// keeps the sort stable. Returns false when every key has the same digit (nothing would move).
+static bool sort_radix_offsets(sort_radix_t *r, size_t blocks)
+{
+    size_t total = 0;
+    for (size_t digit = 0; digit < SORT_RADIX_SIZE; digit++)
+    {
+        size_t start = total;
+        for (size_t block = 0; block < blocks; block++)
+        {
+            size_t count                 = r->histograms[block][digit];
+            r->histograms[block][digit] = total;
+            total += count;
+        }
+        if (total - start == r->count)
+            return false;
+    }
+    return true;
+}
+
+static bool parallel_radix_sort(lum_scheduler_t *scheduler, void *pairs, void *scratch,
+                                size_t count, bool wide)
+{
+    if (!scheduler || !pairs)
+        return false;
+    if (count < 2)
+        return true;
+
+    lum_allocator *allocator  = scheduler->config->allocator;
+    size_t         size       = wide ? sizeof(lum_sort_pair64_t) : sizeof(lum_sort_pair32_t);
+    size_t         block_size = sort_block_size(scheduler, count);
+    size_t         blocks     = (count + block_size - 1) / block_size;
+
+    void *buffer = scratch ? scratch : allocator->alloc(allocator, count * size, 16);
+    sort_radix_t r;
+    r.histograms = allocator->alloc(allocator, blocks * sizeof(r.histograms[0]), 16);
+    if (!buffer || !r.histograms)
+    {
+        if (buffer && buffer != scratch)
+            allocator->free(allocator, buffer);
+        if (r.histograms)
+            allocator->free(allocator, r.histograms);
+        return false;
+    }
+
+    r.src        = pairs;
+    r.dst        = buffer;
+    r.count      = count;
+    r.block_size = block_size;
+    r.wide       = wide;
+    for (r.shift = 0; r.shift < (wide ? 64u : 32u); r.shift += SORT_RADIX_BITS)
+    {
+        sort_for_blocks(scheduler, blocks, sort_radix_histogram, &r);
+        if (!sort_radix_offsets(&r, blocks))
+            continue;
+        sort_for_blocks(scheduler, blocks, sort_radix_scatter, &r);
+
+        const void *sorted = r.dst;
+        r.dst              = (void *) r.src;
+        r.src              = sorted;
+    }
+    if (r.src != pairs)
+    {
+        r.dst = pairs; // An odd number of passes left the result in the scratch buffer
+        sort_for_blocks(scheduler, blocks, sort_radix_copy_back, &r);
+    }
+
+    if (buffer != scratch)
+        allocator->free(allocator, buffer);
+    allocator->free(allocator, r.histograms);
+    return true;
+}
+
+bool lum_parallel_radix_sort32(lum_scheduler_t *scheduler, lum_sort_pair32_t *pairs,
+                               lum_sort_pair32_t *scratch, size_t count)
+{
+    return parallel_radix_sort(scheduler, pairs, scratch, count, false);
+}
+
+bool lum_parallel_radix_sort64(lum_scheduler_t *scheduler, lum_sort_pair64_t *pairs,
+                               lum_sort_pair64_t *scratch, size_t count)
+{
+    return parallel_radix_sort(scheduler, pairs, scratch, count, true);
+}
+
+// ---------------- Merge sort --------------------- //
+
+typedef struct
+{
+    unsigned char        *base;
+    unsigned char        *scratch;
+    size_t                count;
+    size_t                size;
+    lum_sort_compare_func compare;
+    void                 *ctx;
+    size_t                block_size; // Initial sorted runs
+    size_t                width;      // Merge round: length of the runs being merged
+    const unsigned char  *src;
+    unsigned char        *dst;
+} sort_merge_t;
+
+static void sort_swap(unsigned char *a, unsigned char *b, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        unsigned char byte = a[i];
+        a[i]               = b[i];
+        b[i]               = byte;
+    }
+}
+
+// Stable merge of a[0, na) and b[0, nb) into out, taking from a on ties
+static void sort_merge(const sort_merge_t *m, const unsigned char *a, size_t na,
+                       const unsigned char *b, size_t nb, unsigned char *out)
+{
+    size_t size = m->size;
+    while (na > 0 && nb > 0)
+    {
+        if (m->compare(b, a, m->ctx) < 0)
+        {
+            memcpy(out, b, size);
+            b += size;
+            nb--;
+        }
+        else
+        {
+            memcpy(out, a, size);
+            a += size;
+            na--;
+        }
+        out += size;
+    }
+    memcpy(out, a, na * size);
+    memcpy(out + na * size, b, nb * size);
+}
+
+// How many of the first k merged elements come from a (merge path)
+static size_t sort_co_rank(const sort_merge_t *m, const unsigned char *a, size_t na,
+                           const unsigned char *b, size_t nb, size_t k)
+{
+    size_t lo = k > nb ? k - nb : 0;
+    size_t hi = k < na ? k : na;
+    while (lo < hi)
+    {
+        size_t i = lo + (hi - lo) / 2;
+        if (m->compare(a + i * m->size, b + (k - i - 1) * m->size, m->ctx) <= 0)
+            lo = i + 1;
+        else
+            hi = i;
+    }
+    return lo;
+}
+
+// Sort one block serially: insertion sorted runs, then bottom-up merges through the scratch
+static void sort_merge_block(size_t begin, size_t end, void *ctx)
+{
+    sort_merge_t *m    = (sort_merge_t *) ctx;
+    size_t        size = m->size;
+    for (size_t block = begin; block < end; block++)
+    {
+        size_t         lo    = block * m->block_size;
+        size_t         count = m->count - lo > m->block_size ? m->block_size : m->count - lo;
+        unsigned char *src   = m->base + lo * size;
+        unsigned char *dst   = m->scratch + lo * size;
+
+        for (size_t run = 0; run < count; run += SORT_INSERTION_RUN)
+        {
+            size_t run_end = count - run > SORT_INSERTION_RUN ? run + SORT_INSERTION_RUN : count;
+            for (size_t i = run + 1; i < run_end; i++)
+            {
+                for (size_t j = i; j > run && m->compare(src + (j - 1) * size, src + j * size,
+                                                          m->ctx) > 0;
+                     j--)
+                    sort_swap(src + (j - 1) * size, src + j * size, size);
+            }
+        }
+
+        for (size_t width = SORT_INSERTION_RUN; width < count; width *= 2)
+        {
+            for (size_t start = 0; start < count; start += 2 * width)
+            {
+                size_t mid  = count - start > width ? start + width : count;
+                size_t stop = count - mid > width ? mid + width : count;
+                sort_merge(m, src + start * size, mid - start, src + mid * size, stop - mid,
+                           dst + start * size);
+            }
+            unsigned char *sorted = dst;
+            dst                   = src;
+            src                   = sorted;
+        }
+        if (src != m->base + lo * size)
+            memcpy(m->base + lo * size, src, count * size);
+    }
+}
+
+// Merge round: write output positions [begin, end) of every run pair they overlap
+static void sort_merge_segment(size_t begin, size_t end, void *ctx)
+{
+    sort_merge_t *m    = (sort_merge_t *) ctx;
+    size_t        size = m->size;
+    for (size_t lo = begin; lo < end;)
+    {
+        size_t start = lo / (2 * m->width) * (2 * m->width);
+        size_t mid   = m->count - start > m->width ? start + m->width : m->count;
+        size_t stop  = m->count - mid > m->width ? mid + m->width : m->count;
+        size_t hi    = end < stop ? end : stop;
+
+        const unsigned char *a  = m->src + start * size;
+        const unsigned char *b  = m->src + mid * size;
+        size_t               na = mid - start;
+        size_t               nb = stop - mid;
+        size_t               i  = sort_co_rank(m, a, na, b, nb, lo - start);
+        size_t               ie = sort_co_rank(m, a, na, b, nb, hi - start);
+        size_t               j  = lo - start - i;
+        size_t               je = hi - start - ie;
+        sort_merge(m, a + i * size, ie - i, b + j * size, je - j, m->dst + lo * size);
+        lo = hi;
+    }
+}
+
+static void sort_merge_copy_back(size_t begin, size_t end, void *ctx)
+{
+    sort_merge_t *m = (sort_merge_t *) ctx;
+    memcpy(m->dst + begin * m->size, m->src + begin * m->size, (end - begin) * m->size);
+}
+
+bool lum_parallel_merge_sort(lum_scheduler_t *scheduler, void *base, size_t count, size_t size,
+                             lum_sort_compare_func compare, void *ctx)
+{
+    if (!scheduler || !base || !compare || size == 0)
+        return false;
+    if (count < 2)
+        return true;
+
+    lum_allocator *allocator = scheduler->config->allocator;
+    sort_merge_t   m;
+    m.base       = (unsigned char *) base;
+    m.scratch    = allocator->alloc(allocator, count * size, 16);
+    m.count      = count;
+    m.size       = size;
+    m.compare    = compare;
+    m.ctx        = ctx;
+    m.block_size = sort_block_size(scheduler, count);
+    if (!m.scratch)
+        return false;
+
+    size_t blocks = (count + m.block_size - 1) / m.block_size;
+    sort_for_blocks(scheduler, blocks, sort_merge_block, &m);
+
+    // Every round merges runs pairwise; the output is cut into equal segments
+    m.src = m.base;
+    m.dst = m.scratch;
+    for (m.width = m.block_size; m.width < count; m.width *= 2)
+    {
+        lum_parallel_for(scheduler, 0, count, m.block_size, sort_merge_segment, &m);
+        unsigned char *sorted = m.dst;
+        m.dst                 = (unsigned char *) m.src;
+        m.src                 = sorted;
+    }
+    if (m.src != m.base)
+    {
+        m.dst = m.base; // Copy back with the same segments
+        lum_parallel_for(scheduler, 0, count, m.block_size, sort_merge_copy_back, &m);
+    }
+
+    allocator->free(allocator, m.scratch);
+    return true;
+}
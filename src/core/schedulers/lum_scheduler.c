@@ -1,85 +1,951 @@
 #include "lum_scheduler.h"
 
+#include "../containers/cont_wsq.h"
+#include "../math/math_rand.h"
 #include "../memory/allocators/mem_alloc.h"
+#include "../memory/allocators/mem_stack.h"
+#include "lum_fiber.h"
+#include "lum_job_pool.h"
 #include "lum_thread.h"
+#include "lum_trace.h"
 #include "platform.h"
 
 #include <assert.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define SCHEDULER_ALIGNMENT 16
+#define SCHEDULER_JOB_POOL_CAPACITY 1024
+#define SCHEDULER_QUEUE_CAPACITY 4096
+#define SCHEDULER_SPIN_COUNT 4096 // Default LUM_WAIT_HYBRID budget
+#define SCHEDULER_FIBERS_PER_THREAD 32
+#define SCHEDULER_FIBER_STACK_SIZE (128 * 1024)
+#define SCHEDULER_OVERFLOW_HELP_DEPTH 1 // Jobs run to make room in a full queue spill, not help
+#define SCHEDULER_SCRATCH_SIZE (64 * 1024)
+#define SCHEDULER_TIMER_TICK_NS 1000000ull // Timer wheel resolution (1ms)
+
+#ifdef USE_SCHEDULER_TRACE
+#define SCHEDULER_TRACE(w, type, argument)                                                         \
+    do                                                                                             \
+    {                                                                                              \
+        lum_worker_t *trace_worker = (w);                                                          \
+        if (trace_worker)                                                                          \
+            lum_trace_record(&trace_worker->trace, (type), (uint64_t) (argument));                 \
+    } while (0)
+#else
+#define SCHEDULER_TRACE(w, type, argument) ((void) 0)
+#endif
+
+// Workers own their counters, so they bump them without a locked instruction
+#define SCHEDULER_STAT_ADD(s, w, field, n)                                                         \
+    ((w) ? atomic_store_explicit(&(w)->stats.field,                                                \
+                                 atomic_load_explicit(&(w)->stats.field, memory_order_relaxed) +   \
+                                     (uint64_t) (n),                                               \
+                                 memory_order_relaxed)                                             \
+         : (void) atomic_fetch_add_explicit(&(s)->external_stats.field, (uint64_t) (n),            \
+                                            memory_order_relaxed))
+
+// Backoff stages: doubling pause bursts, then yields, then 1ms sleeps
+#define BACKOFF_MAX_PAUSES 64
+#define BACKOFF_YIELDS 16
+
+typedef enum
+{
+    FIBER_AFTER_NONE,
+    FIBER_AFTER_FREE, // Return the fiber to the pool
+    FIBER_AFTER_WAIT  // Park the fiber on a counter
+} fiber_after_action_t;
+
+// What to do with the fiber that was just switched away from. It can only be freed or made
+// resumable once its context has been saved, so the fiber switched to does it.
+typedef struct
+{
+    fiber_after_action_t action;
+    lum_fiber_t         *fiber;
+    lum_counter_t       *counter;
+} fiber_after_t;
+
+// A delayed job, or a job function to run on a fixed period
+struct lum_job_timer
+{
+    lum_timer_t     node; // First member: the wheel hands back node pointers
+    Job            *job;  // One-shot: submitted when due
+    lum_thread_func function; // Periodic: run as a fresh job every period
+    void           *data;
+    uint64_t        period; // Ticks, 0 for one-shot timers
+};
+
+// Per-worker state. Each worker owns a Chase-Lev deque when work stealing is enabled.
+struct lum_worker
+{
+    lum_wsq_t        deque;
+    lum_job_pool_t   pool; // Jobs created on this worker
+    lum_scheduler_t *scheduler;
+    size_t           index;
+    size_t           node;         // NUMA node the worker is pinned to (0 when not NUMA aware)
+    pcg32_random_t   rng;          // Victim selection
+    lum_fiber_t     *fiber;        // Fiber mode: fiber running on this worker
+    lum_fiber_t      thread_fiber; // Fiber mode: the worker thread's own context
+    lum_allocator   *scratch;      // Job scratch arena outside fiber mode
+    unsigned         help_depth;   // Overflow help nesting outside fiber mode
+    fiber_after_t    after;
+    lum_stats_counters_t stats;
+#ifdef USE_SCHEDULER_TRACE
+    lum_trace_buffer_t trace; // Timeline of this worker's thread
+#endif
+} CACHE_ALIGNED;
+
+// Worker running on the current thread (NULL on non-worker threads)
+static THREAD_LOCAL lum_worker_t *tls_worker = NULL;
+
+// Not inlined so the TLS address is never reused across a fiber switch to another thread
+static NOINLINE lum_worker_t *scheduler_tls_worker(void)
+{
+    return tls_worker;
+}
+
+static inline lum_worker_t *scheduler_current_worker(lum_scheduler_t *s)
+{
+    lum_worker_t *w = scheduler_tls_worker();
+    return (w && w->scheduler == s) ? w : NULL;
+}
+
+static inline bool scheduler_workers_park(lum_scheduler_t *s)
+{
+    lum_wait_policy_t policy = s->config->wait_policy;
+    return policy == LUM_WAIT_COND_VAR || policy == LUM_WAIT_HYBRID;
+}
+
+// Wake one parked worker. Only syscalls when a worker is actually parked; spinning workers
+// never park at all.
+static inline void scheduler_notify(lum_scheduler_t *s)
+{
+    if (scheduler_workers_park(s))
+        lum_eventcount_notify_one(&s->job_available);
+}
+
+static inline void scheduler_notify_n(lum_scheduler_t *s, size_t count)
+{
+    if (scheduler_workers_park(s))
+        lum_eventcount_notify_n(&s->job_available, (int) count);
+}
+
+// Index of a job's shared queue and spill list: its priority class with LUM_QUEUE_PRIORITY,
+// else the single queue
+static inline size_t scheduler_class_of(lum_scheduler_t *s, const Job *job)
+{
+    return s->queue_count > 1 ? (size_t) job->priority : 0;
+}
+
+static bool scheduler_has_work(lum_scheduler_t *s)
+{
+    for (size_t i = 0; i < s->queue_count; i++)
+    {
+        if (!lum_lfq_empty(s->queues[i]) || atomic_load(&s->spills[i].count) > 0)
+            return true;
+    }
+    for (size_t i = 0; s->node_queues && i < s->node_count; i++)
+    {
+        if (!lum_lfq_empty(s->node_queues[i]))
+            return true;
+    }
+    if (s->ready_fibers && !lum_lfq_empty(s->ready_fibers))
+        return true;
+    if (s->stealing)
+    {
+        for (size_t i = 0; i < s->config->num_threads; i++)
+        {
+            if (!lum_wsq_empty(&s->workers[i].deque))
+                return true;
+        }
+    }
+    return false;
+}
+
+// Victim selection for threads helping without a worker (e.g. the main thread while waiting)
+static THREAD_LOCAL pcg32_random_t tls_helper_rng = {0x4d595df4d0f33173ULL, 1442695040888963407ULL};
+
+// Try to steal from random victims, visiting every other worker once.
+// Workers on the thief's NUMA node are tried before remote ones.
+// `thief` is NULL for helping non-worker threads.
+static Job *scheduler_steal(lum_scheduler_t *s, lum_worker_t *thief)
+{
+    size_t n = s->config->num_threads;
+    if (n < 2 && thief)
+        return NULL;
+
+    size_t start    = pcg32_random_r(thief ? &thief->rng : &tls_helper_rng) % n;
+    int    passes   = (thief && s->node_count > 1) ? 2 : 1;
+    size_t attempts = 0;
+    Job   *job      = NULL;
+    for (int pass = 0; pass < passes && !job; pass++)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            size_t victim = (start + i) % n;
+            if (thief && victim == thief->index)
+                continue;
+            if (passes == 2 && (s->workers[victim].node == thief->node) != (pass == 0))
+                continue;
+            attempts++;
+            job = lum_wsq_steal(&s->workers[victim].deque);
+            if (job)
+            {
+                SCHEDULER_TRACE(thief, LUM_TRACE_STEAL, victim);
+                SCHEDULER_STAT_ADD(s, thief, steals, 1);
+                break;
+            }
+        }
+    }
+    SCHEDULER_STAT_ADD(s, thief, steal_attempts, attempts);
+    return job;
+}
+
+// Take a job from another NUMA node's queue (all of them for non-worker threads)
+static Job *scheduler_dequeue_remote(lum_scheduler_t *s, lum_worker_t *w)
+{
+    for (size_t i = 0; s->node_queues && i < s->node_count; i++)
+    {
+        if (w && i == w->node)
+            continue;
+        Job *job = lum_lfq_dequeue(s->node_queues[i]);
+        if (job)
+            return job;
+    }
+    return NULL;
+}
+
+// Append jobs to a spill list, keeping their order
+static void scheduler_spill(lum_job_spill_t *spill, Job **jobs, size_t count)
+{
+    for (size_t i = 0; i + 1 < count; i++)
+        jobs[i]->next = jobs[i + 1];
+    jobs[count - 1]->next = NULL;
+
+    lum_mutex_lock(&spill->lock);
+    if (spill->tail)
+        spill->tail->next = jobs[0];
+    else
+        spill->head = jobs[0];
+    spill->tail = jobs[count - 1];
+    atomic_fetch_add_explicit(&spill->count, count, memory_order_release);
+    lum_mutex_unlock(&spill->lock);
+}
+
+// Take the oldest spilled job of class c and move the ones behind it back into the class's
+// shared queue while it has room, ahead of anything submitted later
+static Job *scheduler_unspill(lum_scheduler_t *s, size_t c)
+{
+    lum_job_spill_t *spill = &s->spills[c];
+    lum_mutex_lock(&spill->lock);
+    Job   *job   = spill->head;
+    size_t moved = 0;
+    if (job)
+    {
+        spill->head = job->next;
+        while (spill->head)
+        {
+            Job *next = spill->head->next; // Read first: once queued the job may run and be freed
+            if (!lum_lfq_enqueue(s->queues[c], spill->head))
+                break;
+            spill->head = next;
+            moved++;
+        }
+        if (!spill->head)
+            spill->tail = NULL;
+        atomic_fetch_sub_explicit(&spill->count, moved + 1, memory_order_relaxed);
+    }
+    lum_mutex_unlock(&spill->lock);
+
+    scheduler_notify_n(s, moved);
+    return job;
+}
+
+// Shared queue of class c, then whatever overflowed it
+static inline Job *scheduler_dequeue_class(lum_scheduler_t *s, size_t c)
+{
+    Job *job = lum_lfq_dequeue(s->queues[c]);
+    if (!job && atomic_load_explicit(&s->spills[c].count, memory_order_acquire) > 0)
+        job = scheduler_unspill(s, c);
+    return job;
+}
+
+static void scheduler_poll_timers(lum_scheduler_t *s);
+
+// Due timers first, so they are released even while the queues stay busy. Then the local
+// deque (LIFO, cache-warm), the node and shared queues, steal, and other nodes' queues. With
+// priority queues, critical jobs come before everything and background jobs last.
+static Job *scheduler_find_job(lum_scheduler_t *s, lum_worker_t *w)
+{
+    Job *job      = NULL;
+    bool priority = s->queue_count > 1;
+    if (w)
+        scheduler_poll_timers(s);
+    if (priority)
+    {
+        job = scheduler_dequeue_class(s, LUM_JOB_PRIORITY_CRITICAL);
+        if (job)
+            return job;
+    }
+    if (s->stealing && w)
+    {
+        job = lum_wsq_pop(&w->deque);
+        if (job)
+            return job;
+    }
+    if (s->node_queues && w)
+    {
+        job = lum_lfq_dequeue(s->node_queues[w->node]);
+        if (job)
+            return job;
+    }
+    job = scheduler_dequeue_class(s, priority ? LUM_JOB_PRIORITY_NORMAL : 0);
+    if (job)
+        return job;
+    if (s->stealing)
+    {
+        job = scheduler_steal(s, w);
+        if (job)
+            return job;
+    }
+    job = scheduler_dequeue_remote(s, w);
+    if (job)
+        return job;
+    return priority ? scheduler_dequeue_class(s, LUM_JOB_PRIORITY_BACKGROUND) : NULL;
+}
 
 Job *lum_scheduler_create_job(lum_scheduler_t *scheduler, lum_thread_func function, void *data)
 {
     if (!scheduler || !function)
         return NULL;
-    lum_allocator *allocator = scheduler->config->allocator;
 
-    Job *job = allocator->alloc(allocator, sizeof(Job), 16);
+    // Workers allocate from their own pool; other threads share the external pool
+    Job          *job;
+    lum_worker_t *w = scheduler_current_worker(scheduler);
+    if (w)
+    {
+        job = lum_job_pool_alloc(&w->pool);
+    }
+    else
+    {
+        lum_mutex_lock(&scheduler->submission_lock);
+        job = lum_job_pool_alloc(scheduler->external_pool);
+        lum_mutex_unlock(&scheduler->submission_lock);
+    }
     if (!job)
         return NULL;
 
-    job->function = function;
-    job->data     = data;
+    job->function        = function;
+    job->data            = data;
+    job->successor_count = 0;
+    job->counter         = NULL;
+    job->continuation    = NULL;
+    job->cancel          = NULL;
+    job->priority        = LUM_JOB_PRIORITY_NORMAL;
+    // Held back by one until lum_scheduler_submit so parents finishing early cannot enqueue it
+    atomic_store_explicit(&job->remaining_dependencies, 1, memory_order_relaxed);
     return job;
 }
 
-void execute_job(Job *job, lum_scheduler_t *s)
+Job *lum_scheduler_create_job_inline(lum_scheduler_t *scheduler, lum_thread_func function,
+                                     const void *data, size_t size)
 {
+    assert(size <= LUM_JOB_PAYLOAD_SIZE && "Job payload too large");
+    Job *job = lum_scheduler_create_job(scheduler, function, NULL);
     if (!job)
-        return;
+        return NULL;
+    memcpy(job->payload, data, size);
+    job->data = job->payload;
+    return job;
+}
 
-    // Ensure job function is valid
-    assert(job->function != NULL && "Job function is NULL!");
+// ---------------- Fibers --------------------- //
+// In fiber mode every worker runs its loop on a pooled fiber. A job waiting on a counter parks
+// the fiber it runs on and the worker continues its loop on a fresh fiber; once the counter
+// completes the parked fiber is queued in ready_fibers and resumed by whichever worker finds it
+// first. Fibers only switch on waits, never per job.
 
-    // Execute the job function with the provided data
-    job->function(job->data);
+static lum_fiber_t *fiber_pool_alloc(lum_scheduler_t *s)
+{
+    lum_mutex_lock(&s->fiber_lock);
+    lum_fiber_t *fiber = s->free_fibers;
+    if (fiber)
+        s->free_fibers = fiber->next;
+    lum_mutex_unlock(&s->fiber_lock);
+    return fiber;
+}
+
+static void fiber_pool_free(lum_scheduler_t *s, lum_fiber_t *fiber)
+{
+    lum_mutex_lock(&s->fiber_lock);
+    fiber->next    = s->free_fibers;
+    s->free_fibers = fiber;
+    lum_mutex_unlock(&s->fiber_lock);
+}
+
+// Make every fiber parked on counter resumable
+static void fiber_wake_waiters(lum_scheduler_t *s, lum_counter_t *counter)
+{
+    lum_fiber_t *fiber = atomic_exchange_explicit(&counter->fibers, NULL, memory_order_seq_cst);
+    size_t       woken = 0;
+    while (fiber)
+    {
+        lum_fiber_t *next = fiber->next; // The fiber may be resumed and re-parked right away
+        bool         ok   = lum_lfq_enqueue(s->ready_fibers, fiber);
+        assert(ok && "ready_fibers holds every fiber");
+        (void) ok;
+        fiber = next;
+        woken++;
+    }
+    scheduler_notify_n(s, woken);
+}
+
+// Runs once `fiber` (a job waiting on counter) has been switched away from
+static void fiber_park(lum_scheduler_t *s, lum_fiber_t *fiber, lum_counter_t *counter)
+{
+    // Counted as finishing so the counter stays alive until we are done with it
+    atomic_fetch_add_explicit(&counter->finishing, 1, memory_order_relaxed);
+    lum_fiber_t *head = atomic_load_explicit(&counter->fibers, memory_order_relaxed);
+    do
+    {
+        fiber->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&counter->fibers, &head, fiber,
+                                                    memory_order_seq_cst, memory_order_relaxed));
+
+    // The last job may have finished before the fiber was on the list
+    if (atomic_load_explicit(&counter->value, memory_order_seq_cst) <= 0)
+        fiber_wake_waiters(s, counter);
+    atomic_fetch_sub_explicit(&counter->finishing, 1, memory_order_release);
+}
+
+static void fiber_run_after(lum_scheduler_t *s, lum_worker_t *w)
+{
+    fiber_after_t after = w->after;
+    w->after.action     = FIBER_AFTER_NONE;
+    switch (after.action)
+    {
+    case FIBER_AFTER_FREE:
+        fiber_pool_free(s, after.fiber);
+        break;
+    case FIBER_AFTER_WAIT:
+        fiber_park(s, after.fiber, after.counter);
+        break;
+    case FIBER_AFTER_NONE:
+    default:
+        break;
+    }
+}
+
+// Switch the current worker to `to`, applying `action` to the fiber being left
+static void fiber_switch(lum_scheduler_t *s, lum_fiber_t *to, fiber_after_action_t action,
+                         lum_counter_t *counter)
+{
+    lum_worker_t *w    = scheduler_tls_worker();
+    lum_fiber_t  *from = w->fiber;
+    w->after           = (fiber_after_t){action, from, counter};
+    w->fiber           = to;
+    lum_fiber_switch(from, to);
+
+    // Resumed, possibly on another worker
+    fiber_run_after(s, scheduler_tls_worker());
+}
+// --------------- End Fibers ------------------ //
+
+static void scheduler_stat_max_depth(lum_scheduler_t *s, lum_worker_t *w, size_t depth)
+{
+    atomic_uint_least64_t *max =
+        w ? &w->stats.max_queue_depth : &s->external_stats.max_queue_depth;
+    uint64_t current = atomic_load_explicit(max, memory_order_relaxed);
+    while (depth > current && !atomic_compare_exchange_weak_explicit(max, &current, depth,
+                                                                     memory_order_relaxed,
+                                                                     memory_order_relaxed))
+    {
+    }
+}
+
+// Completion accounting shared by executed and dropped jobs
+static void scheduler_complete_job(lum_scheduler_t *s, Job *job)
+{
+    // The counter may live on the waiter's stack: once value hits zero it can go away as soon
+    // as `finishing` drops back to zero, so that is the last access
+    lum_counter_t *counter = job->counter;
+    if (counter)
+    {
+        atomic_fetch_add_explicit(&counter->finishing, 1, memory_order_relaxed);
+        // seq_cst pairs with fiber_park: either it sees zero or we see its fiber
+        if (atomic_fetch_sub_explicit(&counter->value, 1, memory_order_seq_cst) == 1)
+        {
+            lum_eventcount_notify_all(&counter->waiters);
+            if (atomic_load_explicit(&counter->fibers, memory_order_seq_cst))
+                fiber_wake_waiters(s, counter);
+        }
+        atomic_fetch_sub_explicit(&counter->finishing, 1, memory_order_release);
+    }
 
-    lum_mutex_lock(&s->job_lock);
     if (atomic_fetch_sub(&s->jobs_remaining, 1) == 1)
     {
-        lum_cond_signal(&s->job_done); // Signal main thread if last job
+        lum_eventcount_notify_all(&s->job_done); // Wake waiting threads if last job
     }
-    lum_mutex_unlock(&s->job_lock);
+}
+
+void execute_job(Job *job, lum_scheduler_t *s);
+
+static THREAD_LOCAL unsigned tls_help_depth = 0; // Overflow help nesting of non-worker threads
 
-    // TODO: introduce a job pool
-    if (s)
+// Jobs scheduler_overflow_help is running on the current stack: the fiber's count in fiber mode,
+// where the job may continue on another worker, else the thread's
+static unsigned *scheduler_help_depth(lum_scheduler_t *s, lum_worker_t *w)
+{
+    if (!w)
+        return &tls_help_depth;
+    if (s->fiber_help_depth && w->fiber && w->fiber != &w->thread_fiber)
+        return &s->fiber_help_depth[w->fiber - s->fibers];
+    return &w->help_depth;
+}
+
+// Make room in a full queue by running a job on the calling thread, when it may. A job run this
+// way that fills the queue again spills instead of nesting another job, so the stack stays bounded.
+static bool scheduler_overflow_help(lum_scheduler_t *s, lum_worker_t *w)
+{
+    if (!w && !s->config->help_while_waiting)
+        return false;
+    Job *job = scheduler_find_job(s, w);
+    if (!job)
+        return false;
+    unsigned *depth = scheduler_help_depth(s, w); // Follows the job if its fiber moves
+    (*depth)++;
+    execute_job(job, s);
+    (*depth)--;
+    return true;
+}
+
+// Make runnable jobs visible to the workers: the current worker's deque when possible,
+// otherwise its node's queue or the shared queue, one atomic publish per queue. All jobs must
+// share a priority class; only normal priority jobs stay node-local. Jobs that do not fit go
+// to the class's spill list, or wait for room with LUM_OVERFLOW_BLOCK. Returns `count`.
+static size_t scheduler_enqueue_bulk(lum_scheduler_t *s, Job **jobs, size_t count)
+{
+    size_t        queued = 0;
+    size_t        c      = scheduler_class_of(s, jobs[0]);
+    lum_lfq_t    *queue  = s->queues[c];
+    lum_worker_t *w      = scheduler_current_worker(s);
+    bool          local =
+        w && (s->queue_count == 1 || jobs[0]->priority == LUM_JOB_PRIORITY_NORMAL);
+    bool block = s->config->overflow_policy == LUM_OVERFLOW_BLOCK;
+    if (local && s->stealing)
+        queued = lum_wsq_push_bulk(&w->deque, (void *const *) jobs, count);
+    if (local && s->node_queues)
+        queue = s->node_queues[w->node];
+
+    // While jobs are spilled, later ones queue up behind them to stay in submission order
+    bool full = !block && queue == s->queues[c] &&
+                atomic_load_explicit(&s->spills[c].count, memory_order_relaxed) > 0;
+    size_t overflow = full ? count - queued : 0;
+    while (queued < count && !full)
     {
-        s->config->allocator->free(s->config->allocator, job);
+        size_t n = lum_lfq_enqueue_bulk(queue, (void *const *) (jobs + queued), count - queued);
+        queued += n;
+        if (n > 0)
+            continue;
+        if (!overflow)
+            overflow = count - queued;
+        if (!block || *scheduler_help_depth(s, w) >= SCHEDULER_OVERFLOW_HELP_DEPTH)
+            break;
+        if (!scheduler_overflow_help(s, w))
+            lum_thread_yield();
+        w = scheduler_current_worker(s); // A fiber job may have moved to another worker
     }
+
+    // Depth of the queue the jobs went to, sampled after publishing
+    bool   deque_only = local && s->stealing && queued == count && !overflow;
+    size_t depth      = deque_only ? lum_wsq_size(&w->deque) : lum_lfq_size(queue);
+    scheduler_stat_max_depth(s, w, depth);
+
+    if (queued < count)
+        scheduler_spill(&s->spills[c], jobs + queued, count - queued);
+    if (overflow)
+        SCHEDULER_STAT_ADD(s, w, queue_full, overflow);
+    return count;
 }
 
-void *worker_thread_function(void *arg)
+static void scheduler_enqueue(lum_scheduler_t *s, Job *job)
+{
+    if (scheduler_enqueue_bulk(s, &job, 1))
+        scheduler_notify(s);
+}
+
+// Drop the submission hold of a job already counted in jobs_remaining
+static void scheduler_release_hold(lum_scheduler_t *s, Job *job)
+{
+    // Jobs with unfinished parents are enqueued by the last parent
+    if (atomic_fetch_sub_explicit(&job->remaining_dependencies, 1, memory_order_acq_rel) == 1)
+        scheduler_enqueue(s, job);
+}
+
+static inline uint64_t scheduler_timer_deadline(uint64_t tick)
+{
+    return tick == UINT64_MAX ? UINT64_MAX : tick * SCHEDULER_TIMER_TICK_NS;
+}
+
+// Hand due timers' jobs to the queues. Any worker may do it, the one holding timer_lock wins.
+static void scheduler_poll_timers(lum_scheduler_t *s)
+{
+    uint64_t due = atomic_load_explicit(&s->next_timer, memory_order_acquire);
+    if (due == UINT64_MAX)
+        return;
+    uint64_t now = lum_time_now_ns();
+    if (now < due || !lum_mutex_trylock(&s->timer_lock))
+        return;
+
+    uint64_t     tick  = now / SCHEDULER_TIMER_TICK_NS;
+    Job         *ready = NULL;
+    Job        **tail  = &ready;
+    lum_timer_t *fired = lum_timer_wheel_advance(s->timers, tick);
+    while (fired)
+    {
+        lum_job_timer_t *timer = (lum_job_timer_t *) fired;
+        fired                  = fired->next;
+        Job *job               = timer->job;
+        if (timer->period)
+        {
+            // Keep the cadence, but skip the periods missed while nobody polled
+            timer->node.expires += timer->period;
+            if (timer->node.expires <= tick)
+                timer->node.expires = tick + timer->period;
+            lum_timer_wheel_add(s->timers, &timer->node);
+            job = lum_scheduler_create_job(s, timer->function, timer->data);
+            if (!job)
+                continue;
+            atomic_fetch_add(&s->jobs_remaining, 1);
+        }
+        else
+        {
+            s->config->allocator->free(s->config->allocator, timer);
+        }
+        *tail = job;
+        tail  = &job->next;
+    }
+    *tail = NULL;
+    atomic_store_explicit(&s->next_timer,
+                          scheduler_timer_deadline(lum_timer_wheel_next_tick(s->timers)),
+                          memory_order_release);
+    lum_mutex_unlock(&s->timer_lock);
+
+    while (ready)
+    {
+        Job *job = ready;
+        ready    = job->next;
+        scheduler_release_hold(s, job);
+    }
+}
+
+// Arm a timer `delay_ns` from now, rounded up to whole ticks
+static void scheduler_add_timer(lum_scheduler_t *s, lum_job_timer_t *timer, uint64_t delay_ns)
+{
+    timer->node.expires =
+        (lum_time_now_ns() + delay_ns + SCHEDULER_TIMER_TICK_NS - 1) / SCHEDULER_TIMER_TICK_NS;
+
+    lum_mutex_lock(&s->timer_lock);
+    uint64_t previous = atomic_load_explicit(&s->next_timer, memory_order_relaxed);
+    lum_timer_wheel_add(s->timers, &timer->node);
+    uint64_t next = scheduler_timer_deadline(lum_timer_wheel_next_tick(s->timers));
+    atomic_store_explicit(&s->next_timer, next, memory_order_release);
+    lum_mutex_unlock(&s->timer_lock);
+
+    // Parked workers sleep until the previous deadline, wake one to pick up the earlier one
+    if (next < previous)
+        scheduler_notify(s);
+}
+
+static lum_job_timer_t *scheduler_alloc_timer(lum_scheduler_t *s)
+{
+    lum_job_timer_t *timer = s->config->allocator->alloc(s->config->allocator,
+                                                         sizeof(lum_job_timer_t),
+                                                         _Alignof(lum_job_timer_t));
+    if (timer)
+        memset(timer, 0, sizeof(*timer));
+    return timer;
+}
+
+// Drop one dependency from each successor and enqueue those that became runnable.
+static void scheduler_release_successors(lum_scheduler_t *s, Job *job)
+{
+    for (int i = 0; i < job->successor_count; i++)
+    {
+        Job *child = job->successors[i];
+        if (atomic_fetch_sub_explicit(&child->remaining_dependencies, 1, memory_order_acq_rel) ==
+            1)
+            scheduler_enqueue(s, child);
+    }
+}
+
+// Submit a finished job's continuation on its behalf. Returns it when it should run inline.
+static Job *scheduler_launch_continuation(lum_scheduler_t *s, Job *job)
+{
+    Job *next = job->continuation;
+    if (!next)
+        return NULL;
+    // Counted before job completes, so neither waiter sees the chain finish in between
+    if (!next->counter && job->counter)
+    {
+        atomic_fetch_add_explicit(&job->counter->value, 1, memory_order_relaxed);
+        next->counter = job->counter;
+    }
+    if (!next->cancel)
+        next->cancel = job->cancel;
+    atomic_fetch_add(&s->jobs_remaining, 1);
+
+    if (atomic_fetch_sub_explicit(&next->remaining_dependencies, 1, memory_order_acq_rel) != 1)
+        return NULL; // Its last other parent enqueues it
+    if (s->queue_count > 1 && next->priority != job->priority)
+    {
+        scheduler_enqueue(s, next);
+        return NULL;
+    }
+    return next;
+}
+
+// Scratch arena of the job running on the worker: its fiber's in fiber mode, where the job may
+// continue on another worker, else the worker's own
+static lum_allocator *scheduler_scratch(lum_worker_t *w)
+{
+    if (!w)
+        return NULL;
+    lum_scheduler_t *s = w->scheduler;
+    if (s->fiber_scratch && w->fiber && w->fiber != &w->thread_fiber)
+        return s->fiber_scratch[w->fiber - s->fibers];
+    return w->scratch;
+}
+
+lum_allocator *lum_scheduler_scratch(void)
+{
+    return scheduler_scratch(scheduler_tls_worker());
+}
+
+void execute_job(Job *job, lum_scheduler_t *s)
+{
+    // Continuations that become runnable run right here, without a trip through the queues
+    while (job)
+    {
+        // Ensure job function is valid
+        assert(job->function != NULL && "Job function is NULL!");
+        // Persistent jobs may be relaunched as soon as they complete, read the flag first
+        bool persistent = job->flags & LUM_JOB_FLAG_PERSISTENT;
+        bool cancelled  = job->cancel && lum_cancel_token_cancelled(job->cancel);
+        if (!cancelled)
+        {
+            SCHEDULER_TRACE(scheduler_current_worker(s), LUM_TRACE_JOB_BEGIN, (uintptr_t) job);
+
+            // Any worker's thread, even one helping another scheduler, so nested jobs stay LIFO
+            lum_allocator *scratch = scheduler_scratch(scheduler_tls_worker());
+            size_t         mark    = scratch ? lum_stack_mark(scratch) : 0;
+
+            // Execute the job function with the provided data
+            job->function(job->data);
+
+            if (scratch)
+                lum_stack_rewind(scratch, mark);
+        }
+
+        // In fiber mode the job may have been resumed on another worker
+        lum_worker_t *w = scheduler_current_worker(s);
+        if (cancelled)
+        {
+            SCHEDULER_STAT_ADD(s, w, jobs_cancelled, 1);
+        }
+        else
+        {
+            SCHEDULER_TRACE(w, LUM_TRACE_JOB_END, (uintptr_t) job);
+            SCHEDULER_STAT_ADD(s, w, jobs_executed, 1);
+        }
+
+        // Successors are already counted in jobs_remaining, release them before finishing
+        scheduler_release_successors(s, job);
+        Job *next = scheduler_launch_continuation(s, job);
+        scheduler_complete_job(s, job);
+
+        if (!persistent)
+            lum_job_pool_free(w ? &w->pool : NULL, job);
+        job = next;
+    }
+}
+
+// Park on job_available until work shows up or the scheduler stops
+static void worker_park(lum_scheduler_t *s, lum_worker_t *w)
+{
+    (void) w; // Only used for tracing
+    uint32_t key = lum_eventcount_prepare_wait(&s->job_available);
+    if (!atomic_load(&s->running) || scheduler_has_work(s))
+    {
+        lum_eventcount_cancel_wait(&s->job_available);
+        return;
+    }
+    // Wake up in time for the next timer, see scheduler_poll_timers
+    uint64_t due = atomic_load_explicit(&s->next_timer, memory_order_acquire);
+    uint64_t now = due == UINT64_MAX ? 0 : lum_time_now_ns();
+    if (due <= now)
+    {
+        lum_eventcount_cancel_wait(&s->job_available);
+        return;
+    }
+    SCHEDULER_TRACE(w, LUM_TRACE_PARK, 0);
+    if (due == UINT64_MAX)
+        lum_eventcount_commit_wait(&s->job_available, key);
+    else
+        lum_eventcount_commit_wait_timeout(&s->job_available, key, due - now);
+    SCHEDULER_TRACE(w, LUM_TRACE_WAKE, 0);
+}
+
+// Idle until a job is found (or the scheduler stops), according to the wait policy
+static Job *worker_wait_for_job(lum_scheduler_t *s, lum_worker_t *w)
+{
+    // Hand back other threads' jobs before going idle
+    lum_job_pool_flush(&w->pool);
+
+    uint64_t idle_start = lum_time_now_ns();
+    atomic_store_explicit(&w->stats.idle_since, idle_start, memory_order_relaxed);
+
+    Job   *job    = NULL;
+    size_t polls  = 0;
+    size_t pauses = 1;
+    while (atomic_load_explicit(&s->running, memory_order_relaxed))
+    {
+        switch (s->config->wait_policy)
+        {
+        case LUM_WAIT_SPINLOCK:
+            lum_cpu_relax();
+            break;
+        case LUM_WAIT_BACKOFF:
+            if (pauses <= BACKOFF_MAX_PAUSES)
+            {
+                for (size_t i = 0; i < pauses; i++)
+                    lum_cpu_relax();
+                pauses <<= 1;
+            }
+            else if (polls < BACKOFF_YIELDS)
+            {
+                lum_thread_yield();
+                polls++;
+            }
+            else
+            {
+                lum_thread_sleep(1);
+            }
+            break;
+        case LUM_WAIT_HYBRID:
+            if (polls++ < s->config->spin_count)
+            {
+                lum_cpu_relax();
+                break;
+            }
+            polls = 0;
+            worker_park(s, w);
+            break;
+        case LUM_WAIT_COND_VAR:
+        default:
+            worker_park(s, w);
+            break;
+        }
+
+        job = scheduler_find_job(s, w);
+        if (job)
+            break;
+        if (s->ready_fibers && !lum_lfq_empty(s->ready_fibers))
+            break; // A suspended job can continue, see fiber_worker_loop
+    }
+
+    atomic_store_explicit(&w->stats.idle_since, 0, memory_order_relaxed);
+    SCHEDULER_STAT_ADD(s, w, idle_ns, lum_time_now_ns() - idle_start);
+    return job;
+}
+
+// Worker loop in fiber mode. Resumed fibers take priority over new jobs: they hold jobs that
+// already started. Fibers freed here are always parked inside this loop, so whoever takes one
+// from the pool later simply continues the loop.
+static void fiber_worker_loop(lum_scheduler_t *s)
+{
+    for (;;)
+    {
+        lum_worker_t *w = scheduler_tls_worker();
+        if (!atomic_load(&s->running))
+        {
+            // Give the thread back to its own context, which then exits
+            fiber_switch(s, &w->thread_fiber, FIBER_AFTER_FREE, NULL);
+            continue;
+        }
+
+        lum_fiber_t *ready = lum_lfq_dequeue(s->ready_fibers);
+        if (ready)
+        {
+            fiber_switch(s, ready, FIBER_AFTER_FREE, NULL);
+            continue;
+        }
+
+        Job *job = scheduler_find_job(s, w);
+        if (!job)
+            job = worker_wait_for_job(s, w);
+        if (job)
+            execute_job(job, s);
+    }
+}
+
+static void fiber_main(void *arg)
 {
     lum_scheduler_t *s = (lum_scheduler_t *) arg;
-    if (!s)
+    fiber_run_after(s, scheduler_tls_worker());
+    fiber_worker_loop(s);
+}
+
+void *worker_thread_function(void *arg)
+{
+    lum_worker_t *w = (lum_worker_t *) arg;
+    if (!w)
         return NULL;
+    lum_scheduler_t *s = w->scheduler;
+    tls_worker         = w;
+
+    // Fiber mode: the thread's own context only comes back once the scheduler stops
+    lum_fiber_t *fiber = s->fibers && lum_fiber_from_thread(&w->thread_fiber)
+                             ? fiber_pool_alloc(s)
+                             : NULL;
+    if (fiber)
+    {
+        w->fiber = &w->thread_fiber;
+        fiber_switch(s, fiber, FIBER_AFTER_NONE, NULL);
+        lum_fiber_to_thread(&w->thread_fiber);
+        tls_worker = NULL;
+        return NULL;
+    }
 
     while (atomic_load(&s->running))
     {
-        Job *job = lum_lfq_dequeue(s->config->queue);
-
+        Job *job = scheduler_find_job(s, w);
         if (!job)
-        {
-            // Queue is empty, wait for a new job
-            lum_mutex_lock(&s->job_lock);
-            // Wait until we are explicitly signaled that work is available
-            while (atomic_load(&s->running) && lum_lfq_empty(s->config->queue)) {
-                lum_cond_wait(&s->job_available, &s->job_lock);
-            }
-            
-            job = lum_lfq_dequeue(s->config->queue);
-            lum_mutex_unlock(&s->job_lock);
-        }
-        
+            job = worker_wait_for_job(s, w);
         if (job)
             execute_job(job, s);
     }
+    tls_worker = NULL;
     return NULL;
 }
 
+// NUMA node owning `cpu`, 0 when the topology does not list it
+static size_t scheduler_node_of_cpu(const lum_topology_t *topology, int cpu)
+{
+    for (int i = 0; i < topology->cpu_count; i++)
+    {
+        if (topology->cpus[i] != cpu)
+            continue;
+        size_t node = 0;
+        while ((int) node + 1 < topology->node_count && topology->node_offset[node + 1] <= i)
+            node++;
+        return node;
+    }
+    return 0;
+}
+
 lum_scheduler_t *lum_scheduler_create(lum_scheduler_config_t *config)
 {
     // Allocator
@@ -94,8 +960,8 @@ lum_scheduler_t *lum_scheduler_create(lum_scheduler_config_t *config)
     if (!config->queue)
     {
         if (config->queue_capacity <= 0)
-            config->queue_capacity = 256;
-        config->queue = allocator->alloc(allocator, sizeof(lum_lfq_t), SCHEDULER_ALIGNMENT);
+            config->queue_capacity = SCHEDULER_QUEUE_CAPACITY;
+        config->queue = allocator->alloc(allocator, sizeof(lum_lfq_t), _Alignof(lum_lfq_t));
         if (!config->queue)
         {
             allocator->free(allocator, allocator);
@@ -111,12 +977,80 @@ lum_scheduler_t *lum_scheduler_create(lum_scheduler_config_t *config)
         return NULL;
     }
 
-    scheduler->config  = config;
-    scheduler->running = true;
+    scheduler->config           = config;
+    scheduler->running          = true;
+    scheduler->workers          = NULL;
+    scheduler->external_pool    = NULL;
+    scheduler->threads_started  = 0;
+    scheduler->queue_count      = 0;
+    scheduler->node_queues      = NULL;
+    scheduler->node_count       = 1;
+    scheduler->fibers           = NULL;
+    scheduler->fiber_scratch    = NULL;
+    scheduler->fiber_help_depth = NULL;
+    scheduler->free_fibers      = NULL;
+    scheduler->ready_fibers     = NULL;
+    scheduler->timers           = NULL;
+    lum_mutex_init(&scheduler->fiber_lock);
+    lum_mutex_init(&scheduler->timer_lock);
+    atomic_init(&scheduler->next_timer, UINT64_MAX);
+    memset(scheduler->queues, 0, sizeof(scheduler->queues));
+    memset(&scheduler->external_stats, 0, sizeof(scheduler->external_stats));
+    for (size_t i = 0; i < LUM_JOB_PRIORITY_COUNT; i++)
+    {
+        lum_mutex_init(&scheduler->spills[i].lock);
+        scheduler->spills[i].head = NULL;
+        scheduler->spills[i].tail = NULL;
+        atomic_init(&scheduler->spills[i].count, 0);
+    }
+    scheduler->stealing        = config->type == LUM_SCHEDULER_WORK_STEALING ||
+                          config->queue_type == LUM_QUEUE_PER_THREAD;
+
+    atomic_store(&scheduler->jobs_remaining, 0);
+    lum_mutex_init(&scheduler->submission_lock);
+    lum_eventcount_init(&scheduler->job_available);
+    lum_eventcount_init(&scheduler->job_done);
 
     // TODO: should the queue have its own allocator?
     lum_lfq_init(config->queue, config->queue_capacity, allocator);
 
+    scheduler->timers = allocator->alloc(allocator, sizeof(lum_timer_wheel_t),
+                                         _Alignof(lum_timer_wheel_t));
+    if (!scheduler->timers)
+    {
+        lum_scheduler_destroy(scheduler);
+        return NULL;
+    }
+    lum_timer_wheel_init(scheduler->timers, lum_time_now_ns() / SCHEDULER_TIMER_TICK_NS);
+
+    // Priority classes: config->queue takes normal jobs, the others get their own queue
+    if (config->queue_type == LUM_QUEUE_PRIORITY)
+    {
+        scheduler->queue_count = LUM_JOB_PRIORITY_COUNT;
+        for (size_t i = 0; i < LUM_JOB_PRIORITY_COUNT; i++)
+        {
+            if (i == LUM_JOB_PRIORITY_NORMAL)
+            {
+                scheduler->queues[i] = config->queue;
+                continue;
+            }
+            lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), _Alignof(lum_lfq_t));
+            if (queue)
+                memset(queue, 0, sizeof(lum_lfq_t));
+            scheduler->queues[i] = queue;
+            if (!queue || !lum_lfq_init(queue, config->queue_capacity, allocator))
+            {
+                lum_scheduler_destroy(scheduler);
+                return NULL;
+            }
+        }
+    }
+    else
+    {
+        scheduler->queue_count = 1;
+        scheduler->queues[0]   = config->queue;
+    }
+
     // Threads
     if (config->num_threads <= 0)
         config->num_threads = 4;
@@ -131,16 +1065,184 @@ lum_scheduler_t *lum_scheduler_create(lum_scheduler_config_t *config)
         }
     }
 
-    atomic_store(&scheduler->jobs_remaining, 0);
-    lum_mutex_init(&scheduler->submission_lock);
-    lum_mutex_init(&scheduler->job_lock);
-    lum_cond_init(&scheduler->job_available);
-    lum_cond_init(&scheduler->job_done);
+    if (config->wait_policy == LUM_WAIT_HYBRID && config->spin_count == 0)
+        config->spin_count = SCHEDULER_SPIN_COUNT;
+
+    // Job pools
+    if (config->job_pool_capacity == 0)
+        config->job_pool_capacity = SCHEDULER_JOB_POOL_CAPACITY;
+    if (config->scratch_size == 0)
+        config->scratch_size = SCHEDULER_SCRATCH_SIZE;
+    scheduler->external_pool =
+        allocator->alloc(allocator, sizeof(lum_job_pool_t), _Alignof(lum_job_pool_t));
+    if (!scheduler->external_pool ||
+        !lum_job_pool_init(scheduler->external_pool, config->job_pool_capacity, allocator))
+    {
+        if (scheduler->external_pool)
+            allocator->free(allocator, scheduler->external_pool);
+        scheduler->external_pool = NULL;
+        lum_scheduler_destroy(scheduler);
+        return NULL;
+    }
+
+    // NUMA: workers are spread round-robin over the nodes, each pinned to one of its node's CPUs.
+    // With an explicit CPU set, each worker belongs to its CPU's node instead.
+    if (!config->cpus)
+        config->cpu_count = 0;
+    lum_topology_t topology;
+    if (config->numa_aware)
+    {
+        lum_topology_query(&topology);
+        scheduler->node_count = (size_t) topology.node_count;
+    }
+    if (scheduler->node_count > 1)
+    {
+        scheduler->node_queues = allocator->alloc(
+            allocator, scheduler->node_count * sizeof(lum_lfq_t *), _Alignof(lum_lfq_t *));
+        if (!scheduler->node_queues)
+        {
+            lum_scheduler_destroy(scheduler);
+            return NULL;
+        }
+        memset(scheduler->node_queues, 0, scheduler->node_count * sizeof(lum_lfq_t *));
+        for (size_t i = 0; i < scheduler->node_count; i++)
+        {
+            lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), _Alignof(lum_lfq_t));
+            if (queue)
+                memset(queue, 0, sizeof(lum_lfq_t));
+            scheduler->node_queues[i] = queue;
+            if (!queue || !lum_lfq_init(queue, config->queue_capacity, allocator))
+            {
+                lum_scheduler_destroy(scheduler);
+                return NULL;
+            }
+        }
+    }
+
+    // Fibers: at least one per worker plus one so a waiting job can always be switched away from
+    if (config->use_fibers)
+    {
+        if (config->fiber_count == 0)
+            config->fiber_count = config->num_threads * SCHEDULER_FIBERS_PER_THREAD;
+        if (config->fiber_count <= config->num_threads)
+            config->fiber_count = config->num_threads + 1;
+        if (config->fiber_stack_size == 0)
+            config->fiber_stack_size = SCHEDULER_FIBER_STACK_SIZE;
+
+        scheduler->fibers = allocator->alloc(
+            allocator, config->fiber_count * sizeof(lum_fiber_t), _Alignof(lum_fiber_t));
+        scheduler->ready_fibers =
+            allocator->alloc(allocator, sizeof(lum_lfq_t), _Alignof(lum_lfq_t));
+        if (scheduler->ready_fibers)
+            memset(scheduler->ready_fibers, 0, sizeof(lum_lfq_t));
+        if (!scheduler->fibers || !scheduler->ready_fibers ||
+            !lum_lfq_init(scheduler->ready_fibers, config->fiber_count, allocator))
+        {
+            lum_scheduler_destroy(scheduler);
+            return NULL;
+        }
+        memset(scheduler->fibers, 0, config->fiber_count * sizeof(lum_fiber_t));
+        for (size_t i = 0; i < config->fiber_count; i++)
+        {
+            if (!lum_fiber_create(&scheduler->fibers[i], config->fiber_stack_size, fiber_main,
+                                  scheduler))
+            {
+                lum_scheduler_destroy(scheduler);
+                return NULL;
+            }
+            fiber_pool_free(scheduler, &scheduler->fibers[i]);
+        }
+
+        scheduler->fiber_scratch = allocator->alloc(
+            allocator, config->fiber_count * sizeof(lum_allocator *), _Alignof(lum_allocator *));
+        if (!scheduler->fiber_scratch)
+        {
+            lum_scheduler_destroy(scheduler);
+            return NULL;
+        }
+        memset(scheduler->fiber_scratch, 0, config->fiber_count * sizeof(lum_allocator *));
+        scheduler->fiber_help_depth = allocator->alloc(
+            allocator, config->fiber_count * sizeof(unsigned), _Alignof(unsigned));
+        if (!scheduler->fiber_help_depth)
+        {
+            lum_scheduler_destroy(scheduler);
+            return NULL;
+        }
+        memset(scheduler->fiber_help_depth, 0, config->fiber_count * sizeof(unsigned));
+        for (size_t i = 0; i < config->fiber_count; i++)
+        {
+            scheduler->fiber_scratch[i] = lum_create_stack_allocator(config->scratch_size);
+            if (!scheduler->fiber_scratch[i])
+            {
+                lum_scheduler_destroy(scheduler);
+                return NULL;
+            }
+        }
+    }
+
+    // Workers
+    scheduler->workers = allocator->alloc(allocator, config->num_threads * sizeof(lum_worker_t),
+                                          _Alignof(lum_worker_t));
+    if (!scheduler->workers)
+    {
+        lum_scheduler_destroy(scheduler);
+        return NULL;
+    }
+    memset(scheduler->workers, 0, config->num_threads * sizeof(lum_worker_t));
+    for (size_t i = 0; i < config->num_threads; i++)
+    {
+        lum_worker_t *w = &scheduler->workers[i];
+        w->scheduler    = scheduler;
+        w->index        = i;
+        w->node         = i % scheduler->node_count;
+        if (config->cpu_count > 0 && scheduler->node_count > 1)
+            w->node = scheduler_node_of_cpu(&topology, config->cpus[i % config->cpu_count]);
+        w->rng          = (pcg32_random_t){.state = 0x853c49e6748fea9bULL + i,
+                                           .inc   = ((uint64_t) i << 1u) | 1u};
+        w->scratch = lum_create_stack_allocator(config->scratch_size);
+        if (!w->scratch || !lum_job_pool_init(&w->pool, config->job_pool_capacity, allocator) ||
+            (scheduler->stealing && !lum_wsq_init(&w->deque, config->queue_capacity, allocator)))
+        {
+            lum_scheduler_destroy(scheduler);
+            return NULL;
+        }
+#ifdef USE_SCHEDULER_TRACE
+        if (!lum_trace_buffer_init(&w->trace, LUM_TRACE_CAPACITY, allocator))
+        {
+            lum_scheduler_destroy(scheduler);
+            return NULL;
+        }
+#endif
+    }
+    scheduler->stats_start = lum_time_now_ns();
+#ifdef USE_SCHEDULER_TRACE
+    scheduler->trace_start = scheduler->stats_start;
+#endif
 
     // Launch threads
     for (size_t i = 0; i < config->num_threads; i++)
     {
-        lum_thread_init(&config->threads[i], i, worker_thread_function, (void *) scheduler);
+        lum_thread_t *thread = &config->threads[i];
+        int           id     = (int) i;
+        thread->type         = LUM_THREAD_TASK;
+        thread->numa_node    = 0;
+        if (config->cpu_count > 0)
+        {
+            thread->type      = LUM_THREAD_PINNED;
+            thread->numa_node = (int) scheduler->workers[i].node;
+            id                = config->cpus[i % config->cpu_count];
+        }
+        else if (config->numa_aware)
+        {
+            int node          = (int) scheduler->workers[i].node;
+            int first         = topology.node_offset[node];
+            int node_cpus     = topology.node_offset[node + 1] - first;
+            thread->type      = LUM_THREAD_NUMA;
+            thread->numa_node = node;
+            id                = topology.cpus[first + (int) (i / scheduler->node_count) % node_cpus];
+        }
+        lum_thread_init(thread, id, worker_thread_function, (void *) &scheduler->workers[i]);
+        scheduler->threads_started++;
     }
 
     return scheduler;
@@ -148,48 +1250,229 @@ lum_scheduler_t *lum_scheduler_create(lum_scheduler_config_t *config)
 
 void lum_scheduler_submit_batch(lum_scheduler_t *scheduler, Job **jobs, size_t count)
 {
-    lum_mutex_lock(&scheduler->submission_lock);
-    bool did_submit = false;
+    lum_scheduler_submit_batch_counted(scheduler, jobs, count, NULL);
+}
+
+void lum_scheduler_submit_batch_counted(lum_scheduler_t *scheduler, Job **jobs, size_t count,
+                                        lum_counter_t *counter)
+{
+    if (!scheduler || !jobs || count == 0)
+        return;
+
+    // Counters are bumped once for the whole batch, before any job becomes visible
+    if (counter)
+    {
+        atomic_fetch_add_explicit(&counter->value, (int) count, memory_order_relaxed);
+        for (size_t i = 0; i < count; i++)
+            jobs[i]->counter = counter;
+    }
+    atomic_fetch_add(&scheduler->jobs_remaining, (int) count);
+
+    // Publish each contiguous run of runnable jobs of one priority class straight from the
+    // caller's array; jobs still waiting on parents are enqueued later by their last parent.
+    size_t queued    = 0;
+    size_t run_start = 0;
     for (size_t i = 0; i < count; i++)
     {
-        if (!lum_lfq_enqueue(scheduler->config->queue, jobs[i]))
+        bool runnable =
+            atomic_fetch_sub_explicit(&jobs[i]->remaining_dependencies, 1, memory_order_acq_rel) ==
+            1;
+        if (i > run_start && (!runnable || jobs[i]->priority != jobs[run_start]->priority))
         {
-            printf("Queue is full! Job submission failed.\n");
-            break;
+            queued += scheduler_enqueue_bulk(scheduler, jobs + run_start, i - run_start);
+            run_start = i;
         }
-        else
-            did_submit = true;
+        if (!runnable)
+            run_start = i + 1;
     }
-    if (did_submit)
-        lum_cond_signal(&scheduler->job_available);
-    lum_mutex_unlock(&scheduler->submission_lock);
+    if (count > run_start)
+        queued += scheduler_enqueue_bulk(scheduler, jobs + run_start, count - run_start);
+
+    // Wake at most one parked worker per queued job
+    scheduler_notify_n(scheduler, queued);
 }
 
-void lum_scheduler_submit(lum_scheduler_t *scheduler, Job *job)
+void lum_counter_init(lum_counter_t *counter)
+{
+    atomic_init(&counter->value, 0);
+    atomic_init(&counter->finishing, 0);
+    atomic_init(&counter->fibers, NULL);
+    lum_eventcount_init(&counter->waiters);
+}
+
+bool lum_counter_done(lum_counter_t *counter)
+{
+    return atomic_load_explicit(&counter->value, memory_order_acquire) <= 0 &&
+           atomic_load_explicit(&counter->finishing, memory_order_acquire) == 0;
+}
+
+void lum_scheduler_submit_counted(lum_scheduler_t *scheduler, Job *job, lum_counter_t *counter)
 {
-    // TODO: this queue should be lockless - refactor.
-    //lum_mutex_lock(&scheduler->submission_lock);
-    if (!lum_lfq_enqueue(scheduler->config->queue, job))
+    if (counter)
     {
-        printf("Queue is full! Job submission failed. Capacity %zu.\n",
-            scheduler->config->queue->capacity);
+        atomic_fetch_add_explicit(&counter->value, 1, memory_order_relaxed);
+        job->counter = counter;
     }
-    else
+    lum_scheduler_submit(scheduler, job);
+}
+
+void lum_scheduler_submit(lum_scheduler_t *scheduler, Job *job)
+{
+    // Count the job before it becomes visible so a fast worker cannot finish it first
+    atomic_fetch_add(&scheduler->jobs_remaining, 1);
+
+    // Jobs spawned from inside a job stay on the worker's own deque
+    scheduler_release_hold(scheduler, job);
+}
+
+void lum_scheduler_submit_after(lum_scheduler_t *scheduler, Job *job, uint32_t delay_ms)
+{
+    lum_job_timer_t *timer = delay_ms ? scheduler_alloc_timer(scheduler) : NULL;
+    if (!timer)
     {
-        atomic_fetch_add(&scheduler->jobs_remaining, 1);
-        lum_cond_signal(&scheduler->job_available);
+        lum_scheduler_submit(scheduler, job);
+        return;
     }
-    //lum_mutex_unlock(&scheduler->submission_lock);
+    // Pending from now on, so lum_scheduler_wait_completion covers the delay
+    atomic_fetch_add(&scheduler->jobs_remaining, 1);
+    timer->job = job;
+    scheduler_add_timer(scheduler, timer, (uint64_t) delay_ms * 1000000ull);
+}
+
+lum_job_timer_t *lum_scheduler_submit_periodic(lum_scheduler_t *scheduler,
+                                               lum_thread_func function, void *data,
+                                               uint32_t period_ms)
+{
+    lum_job_timer_t *timer = scheduler_alloc_timer(scheduler);
+    if (!timer)
+        return NULL;
+    timer->function = function;
+    timer->data     = data;
+    timer->period   = period_ms ? period_ms : 1; // One tick is one millisecond
+    scheduler_add_timer(scheduler, timer, timer->period * SCHEDULER_TIMER_TICK_NS);
+    return timer;
+}
+
+void lum_scheduler_cancel_timer(lum_scheduler_t *scheduler, lum_job_timer_t *timer)
+{
+    if (!timer)
+        return;
+    // Periodic timers stay in the wheel between runs, only the poller takes them out briefly
+    lum_mutex_lock(&scheduler->timer_lock);
+    lum_timer_wheel_remove(scheduler->timers, &timer->node);
+    atomic_store_explicit(&scheduler->next_timer,
+                          scheduler_timer_deadline(lum_timer_wheel_next_tick(scheduler->timers)),
+                          memory_order_release);
+    lum_mutex_unlock(&scheduler->timer_lock);
+    scheduler->config->allocator->free(scheduler->config->allocator, timer);
 }
 
 void lum_scheduler_wait_completion(lum_scheduler_t *scheduler)
 {
-    lum_mutex_lock(&scheduler->job_lock);
+    bool          help = scheduler->config->help_while_waiting;
+    lum_worker_t *w    = scheduler_current_worker(scheduler);
+
     while (atomic_load(&scheduler->jobs_remaining) > 0)
     {
-        lum_cond_wait(&scheduler->job_done, &scheduler->job_lock);
+        if (help)
+        {
+            Job *job = scheduler_find_job(scheduler, w);
+            if (job)
+            {
+                execute_job(job, scheduler);
+                continue;
+            }
+        }
+
+        // Nothing left to pick up, the remaining jobs are running elsewhere
+        uint32_t key = lum_eventcount_prepare_wait(&scheduler->job_done);
+        if (atomic_load(&scheduler->jobs_remaining) <= 0)
+            lum_eventcount_cancel_wait(&scheduler->job_done);
+        else
+            lum_eventcount_commit_wait(&scheduler->job_done, key);
+    }
+}
+
+void lum_scheduler_wait_until(lum_scheduler_t *scheduler, atomic_int *counter)
+{
+    lum_worker_t *w      = scheduler_current_worker(scheduler);
+    size_t        pauses = 1;
+
+    while (atomic_load_explicit(counter, memory_order_acquire) > 0)
+    {
+        Job *job = scheduler_find_job(scheduler, w);
+        if (job)
+        {
+            execute_job(job, scheduler);
+            pauses = 1;
+            continue;
+        }
+
+        // The counter is not owned by the scheduler so nobody will wake us: back off instead
+        if (pauses <= BACKOFF_MAX_PAUSES)
+        {
+            for (size_t i = 0; i < pauses; i++)
+                lum_cpu_relax();
+            pauses <<= 1;
+        }
+        else
+        {
+            lum_thread_yield();
+        }
+    }
+}
+
+static void scheduler_wait_counter(lum_scheduler_t *scheduler, lum_counter_t *counter, bool help)
+{
+    lum_worker_t *w = scheduler_current_worker(scheduler);
+
+    // Jobs on fibers park until the counter completes (possibly resuming on another worker)
+    if (w && scheduler->fibers && w->fiber && w->fiber != &w->thread_fiber)
+    {
+        while (!lum_counter_done(counter))
+        {
+            lum_fiber_t *next = fiber_pool_alloc(scheduler);
+            if (!next)
+                break; // Pool exhausted: wait on this stack instead
+            SCHEDULER_TRACE(scheduler_current_worker(scheduler), LUM_TRACE_JOB_SUSPEND, 0);
+            fiber_switch(scheduler, next, FIBER_AFTER_WAIT, counter);
+            SCHEDULER_TRACE(scheduler_current_worker(scheduler), LUM_TRACE_JOB_RESUME, 0);
+        }
+        w = scheduler_current_worker(scheduler);
+    }
+
+    while (!lum_counter_done(counter))
+    {
+        if (help)
+        {
+            Job *job = scheduler_find_job(scheduler, w);
+            if (job)
+            {
+                execute_job(job, scheduler);
+                continue;
+            }
+        }
+
+        // Remaining jobs are running elsewhere, sleep until the last one finishes
+        // Only sleep on the value: a job that already notified may still be finishing
+        uint32_t key = lum_eventcount_prepare_wait(&counter->waiters);
+        if (atomic_load_explicit(&counter->value, memory_order_acquire) <= 0)
+            lum_eventcount_cancel_wait(&counter->waiters);
+        else
+            lum_eventcount_commit_wait(&counter->waiters, key);
     }
-    lum_mutex_unlock(&scheduler->job_lock);
+}
+
+void lum_scheduler_wait_counter(lum_scheduler_t *scheduler, lum_counter_t *counter)
+{
+    // Without a fiber to switch to, a worker has to run jobs itself or risk deadlocking
+    scheduler_wait_counter(scheduler, counter,
+                           scheduler->config->help_while_waiting || scheduler->fibers);
+}
+
+void lum_scheduler_wait_counter_helping(lum_scheduler_t *scheduler, lum_counter_t *counter)
+{
+    scheduler_wait_counter(scheduler, counter, true);
 }
 
 void lum_scheduler_destroy(lum_scheduler_t *scheduler)
@@ -202,24 +1485,117 @@ void lum_scheduler_destroy(lum_scheduler_t *scheduler)
 
     // Signal threads to stop
     atomic_store(&scheduler->running, false);
-    lum_cond_broadcast(&scheduler->job_available); // Flush.
+    lum_eventcount_notify_all(&scheduler->job_available); // Flush.
 
     // Join all worker threads
-    for (size_t i = 0; i < scheduler->config->num_threads; i++)
+    for (size_t i = 0; i < scheduler->threads_started; i++)
     {
         lum_thread_join(scheduler->config->threads[i].thread);
     }
 
     lum_mutex_destroy(&scheduler->submission_lock);
-    lum_mutex_destroy(&scheduler->job_lock);
-    lum_cond_destroy(&scheduler->job_available);
-    lum_cond_destroy(&scheduler->job_done);
+    if (scheduler->fibers)
+    {
+        for (size_t i = 0; i < scheduler->config->fiber_count; i++)
+            lum_fiber_destroy(&scheduler->fibers[i]);
+        scheduler->config->allocator->free(scheduler->config->allocator, scheduler->fibers);
+        scheduler->fibers = NULL;
+    }
+    if (scheduler->fiber_scratch)
+    {
+        for (size_t i = 0; i < scheduler->config->fiber_count; i++)
+            lum_destroy_stack_allocator(scheduler->fiber_scratch[i]);
+        scheduler->config->allocator->free(scheduler->config->allocator,
+                                           scheduler->fiber_scratch);
+        scheduler->fiber_scratch = NULL;
+    }
+    if (scheduler->fiber_help_depth)
+    {
+        scheduler->config->allocator->free(scheduler->config->allocator,
+                                           scheduler->fiber_help_depth);
+        scheduler->fiber_help_depth = NULL;
+    }
+    if (scheduler->ready_fibers)
+    {
+        lum_lfq_destroy(scheduler->ready_fibers);
+        scheduler->config->allocator->free(scheduler->config->allocator, scheduler->ready_fibers);
+        scheduler->ready_fibers = NULL;
+    }
+    lum_mutex_destroy(&scheduler->fiber_lock);
+    if (scheduler->timers)
+    {
+        // Timers that never fired. Their one-shot jobs (and continuations) go back to their
+        // pools: jobs an exhausted pool took from the allocator are not freed with the pool.
+        lum_timer_t *pending = lum_timer_wheel_advance(scheduler->timers, UINT64_MAX);
+        while (pending)
+        {
+            lum_job_timer_t *timer = (lum_job_timer_t *) pending;
+            pending                = pending->next;
+            for (Job *job = timer->job; job;)
+            {
+                Job *next = job->continuation;
+                lum_job_pool_free(job->pool, job); // Workers are joined, every pool is local
+                job = next;
+            }
+            scheduler->config->allocator->free(scheduler->config->allocator, timer);
+        }
+        scheduler->config->allocator->free(scheduler->config->allocator, scheduler->timers);
+        scheduler->timers = NULL;
+    }
+    lum_mutex_destroy(&scheduler->timer_lock);
+    for (size_t i = 0; i < LUM_JOB_PRIORITY_COUNT; i++)
+        lum_mutex_destroy(&scheduler->spills[i].lock);
+    for (size_t i = 0; i < LUM_JOB_PRIORITY_COUNT; i++)
+    {
+        lum_lfq_t *queue = scheduler->queues[i];
+        if (queue && queue != scheduler->config->queue)
+        {
+            lum_lfq_destroy(queue);
+            scheduler->config->allocator->free(scheduler->config->allocator, queue);
+        }
+    }
+    if (scheduler->node_queues)
+    {
+        for (size_t i = 0; i < scheduler->node_count; i++)
+        {
+            if (!scheduler->node_queues[i])
+                continue;
+            lum_lfq_destroy(scheduler->node_queues[i]);
+            scheduler->config->allocator->free(scheduler->config->allocator,
+                                               scheduler->node_queues[i]);
+        }
+        scheduler->config->allocator->free(scheduler->config->allocator, scheduler->node_queues);
+        scheduler->node_queues = NULL;
+    }
     if (scheduler->config->queue)
     {
+        lum_lfq_destroy(scheduler->config->queue);
         scheduler->config->allocator->free(scheduler->config->allocator, scheduler->config->queue);
         scheduler->config->queue = NULL;
     }
 
+    if (scheduler->workers)
+    {
+        for (size_t i = 0; i < scheduler->config->num_threads; i++)
+        {
+            lum_wsq_destroy(&scheduler->workers[i].deque);
+            lum_job_pool_destroy(&scheduler->workers[i].pool);
+            lum_destroy_stack_allocator(scheduler->workers[i].scratch);
+#ifdef USE_SCHEDULER_TRACE
+            lum_trace_buffer_destroy(&scheduler->workers[i].trace);
+#endif
+        }
+        scheduler->config->allocator->free(scheduler->config->allocator, scheduler->workers);
+        scheduler->workers = NULL;
+    }
+
+    if (scheduler->external_pool)
+    {
+        lum_job_pool_destroy(scheduler->external_pool);
+        scheduler->config->allocator->free(scheduler->config->allocator, scheduler->external_pool);
+        scheduler->external_pool = NULL;
+    }
+
     if (scheduler->config->threads)
     {
         scheduler->config->allocator->free(scheduler->config->allocator, scheduler->config->threads);
@@ -232,4 +1608,158 @@ void lum_scheduler_destroy(lum_scheduler_t *scheduler)
         scheduler = NULL;
     }
     // Note: the allocator is passed in by the client, so it is not freed.
-}
\ No newline at end of file
+}
+
+bool lum_scheduler_trace_export(lum_scheduler_t *scheduler, FILE *file)
+{
+#ifdef USE_SCHEDULER_TRACE
+    if (!scheduler || !file)
+        return false;
+
+    bool first = true;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    for (size_t i = 0; i < scheduler->config->num_threads; i++)
+    {
+        fprintf(file,
+                "%s\n{\"pid\":0,\"tid\":%zu,\"ph\":\"M\",\"name\":\"thread_name\","
+                "\"args\":{\"name\":\"worker %zu\"}}",
+                first ? "" : ",", i, i);
+        first = false;
+        lum_trace_write_json(&scheduler->workers[i].trace, file, (int) i, scheduler->trace_start,
+                             &first);
+    }
+    fprintf(file, "\n]}\n");
+    return !ferror(file);
+#else
+    (void) scheduler;
+    (void) file;
+    return false;
+#endif
+}
+
+// Add one set of counters to a snapshot; busy time is whatever part of `elapsed` was not idle
+static void scheduler_stats_accumulate(lum_scheduler_stats_t *stats,
+                                       const lum_stats_counters_t *counters, uint64_t now,
+                                       uint64_t elapsed)
+{
+    uint64_t idle  = atomic_load_explicit(&counters->idle_ns, memory_order_relaxed);
+    uint64_t since = atomic_load_explicit(&counters->idle_since, memory_order_relaxed);
+    if (since && since < now)
+        idle += now - since; // Still waiting
+    if (elapsed)
+        stats->busy_ns += elapsed > idle ? elapsed - idle : 0;
+
+    stats->jobs_executed += atomic_load_explicit(&counters->jobs_executed, memory_order_relaxed);
+    stats->jobs_cancelled += atomic_load_explicit(&counters->jobs_cancelled, memory_order_relaxed);
+    stats->steal_attempts += atomic_load_explicit(&counters->steal_attempts, memory_order_relaxed);
+    stats->steals += atomic_load_explicit(&counters->steals, memory_order_relaxed);
+    stats->idle_ns += idle;
+    stats->queue_full += atomic_load_explicit(&counters->queue_full, memory_order_relaxed);
+
+    uint64_t depth = atomic_load_explicit(&counters->max_queue_depth, memory_order_relaxed);
+    if (depth > stats->max_queue_depth)
+        stats->max_queue_depth = depth;
+}
+
+void lum_scheduler_get_stats(lum_scheduler_t *scheduler, lum_scheduler_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!scheduler)
+        return;
+
+    uint64_t now     = lum_time_now_ns();
+    uint64_t elapsed = now - scheduler->stats_start;
+    for (size_t i = 0; i < scheduler->config->num_threads; i++)
+        scheduler_stats_accumulate(stats, &scheduler->workers[i].stats, now, elapsed);
+    scheduler_stats_accumulate(stats, &scheduler->external_stats, now, 0);
+}
+
+bool lum_scheduler_get_worker_stats(lum_scheduler_t *scheduler, size_t worker,
+                                    lum_scheduler_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    if (!scheduler || worker >= scheduler->config->num_threads)
+        return false;
+
+    uint64_t now = lum_time_now_ns();
+    scheduler_stats_accumulate(stats, &scheduler->workers[worker].stats, now,
+                               now - scheduler->stats_start);
+    return true;
+}
+
+void lum_scheduler_manager_init(lum_scheduler_manager_t *manager)
+{
+    memset(manager, 0, sizeof(*manager));
+}
+
+lum_scheduler_t *lum_scheduler_manager_add(lum_scheduler_manager_t *manager,
+                                           lum_scheduler_config_t *config)
+{
+    if (!manager || !config || manager->count >= LUM_MAX_SCHEDULERS)
+        return NULL;
+    lum_scheduler_t *scheduler = lum_scheduler_create(config);
+    if (scheduler)
+        manager->schedulers[manager->count++] = scheduler;
+    return scheduler;
+}
+
+bool lum_scheduler_manager_route(lum_scheduler_manager_t *manager, uint32_t tag,
+                                 lum_scheduler_t *scheduler)
+{
+    if (!manager || tag >= LUM_MAX_JOB_TAGS)
+        return false;
+    for (size_t i = 0; i < manager->count; i++)
+    {
+        if (manager->schedulers[i] == scheduler)
+        {
+            manager->routes[tag] = (uint8_t) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+lum_scheduler_t *lum_scheduler_manager_get(lum_scheduler_manager_t *manager, uint32_t tag)
+{
+    if (!manager || manager->count == 0)
+        return NULL;
+    return manager->schedulers[tag < LUM_MAX_JOB_TAGS ? manager->routes[tag] : 0];
+}
+
+Job *lum_scheduler_manager_create_job(lum_scheduler_manager_t *manager, uint32_t tag,
+                                      lum_thread_func function, void *data)
+{
+    lum_scheduler_t *scheduler = lum_scheduler_manager_get(manager, tag);
+    return scheduler ? lum_scheduler_create_job(scheduler, function, data) : NULL;
+}
+
+void lum_scheduler_manager_submit(lum_scheduler_manager_t *manager, uint32_t tag, Job *job)
+{
+    lum_scheduler_t *scheduler = lum_scheduler_manager_get(manager, tag);
+    if (scheduler && job)
+        lum_scheduler_submit(scheduler, job);
+}
+
+void lum_scheduler_manager_wait_completion(lum_scheduler_manager_t *manager)
+{
+    // Jobs finishing on one scheduler may have submitted to one that was already waited for
+    bool idle = false;
+    while (!idle)
+    {
+        for (size_t i = 0; i < manager->count; i++)
+            lum_scheduler_wait_completion(manager->schedulers[i]);
+        idle = true;
+        for (size_t i = 0; i < manager->count; i++)
+            idle = idle && atomic_load(&manager->schedulers[i]->jobs_remaining) == 0;
+    }
+}
+
+void lum_scheduler_manager_destroy(lum_scheduler_manager_t *manager)
+{
+    if (!manager)
+        return;
+    // Later schedulers may still hold jobs that submit to earlier ones
+    while (manager->count > 0)
+        lum_scheduler_destroy(manager->schedulers[--manager->count]);
+    memset(manager->routes, 0, sizeof(manager->routes));
+}
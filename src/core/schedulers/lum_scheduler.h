@@ -2,9 +2,16 @@
 #define LUM_SCHEDULER_H
 
 #include "containers/cont_lfq.h"
+#include "lum_timer_wheel.h"
 #include "threads/lum_thread.h"
 
+#include <stdio.h>
+
 typedef struct lum_allocator lum_allocator;
+typedef struct lum_worker    lum_worker_t;
+typedef struct lum_job_pool  lum_job_pool_t;
+typedef struct lum_fiber     lum_fiber_t;
+typedef struct lum_job_timer lum_job_timer_t;
 
 typedef enum
 {
@@ -14,50 +21,217 @@ typedef enum
 
 typedef enum {
     LUM_QUEUE_FIFO,      // Default lock-free queue
-    LUM_QUEUE_PRIORITY,  // Priority queue (min/max heap)
+    LUM_QUEUE_PRIORITY,  // One lock-free queue per lum_job_priority_t class
     LUM_QUEUE_PER_THREAD // Work-stealing thread-local queues
 } lum_queue_type_t;
 
 typedef enum
 {
-    LUM_WAIT_COND_VAR, // Default: Use condition variables (Best CPU usage)
+    LUM_WAIT_COND_VAR, // Default: Park on a futex eventcount (Best CPU usage)
     LUM_WAIT_BACKOFF,  // Use sched_yield + incremental sleep (Low latency)
-    LUM_WAIT_SPINLOCK  // Spin-wait (High-performance networking, rendering)
+    LUM_WAIT_SPINLOCK, // Spin-wait (High-performance networking, rendering)
+    LUM_WAIT_HYBRID    // Spin for spin_count polls, then park
 } lum_wait_policy_t;
 
+// What submitting does when the target queue is full
+typedef enum
+{
+    LUM_OVERFLOW_SPILL, // Default: keep the extra jobs on an unbounded spill list
+    LUM_OVERFLOW_BLOCK  // Wait for room; workers and help_while_waiting threads run jobs meanwhile
+                        // (jobs run that way spill rather than wait, bounding the nesting)
+} lum_overflow_policy_t;
+
 typedef struct
 {
     lum_wait_policy_t       wait_policy;
+    size_t                  spin_count;         // LUM_WAIT_HYBRID: polls before parking
+    bool                    help_while_waiting; // wait_completion runs queued jobs itself
     lum_balance_policy_t    type;
+    lum_queue_type_t        queue_type;
     size_t                  num_threads;
-    size_t                  queue_capacity;
+    size_t                  queue_capacity;    // Shared queue and per-worker deque capacity
+    lum_overflow_policy_t   overflow_policy;   // When a queue is full
+    size_t                  job_pool_capacity; // Pooled jobs per thread before falling back
+    bool                    numa_aware; // Pin workers to CPUs, one shared queue per NUMA node
+    const int              *cpus;      // Pin worker i to cpus[i % cpu_count] (overrides NUMA's)
+    size_t                  cpu_count; // 0: NUMA placement when numa_aware, else unpinned
+    bool                    use_fibers; // Run jobs on fibers so waiting jobs can be suspended
+    size_t                  fiber_count;      // Pooled fibers (stacks) shared by all workers
+    size_t                  fiber_stack_size; // Bytes per fiber stack
+    size_t                  scratch_size; // Job scratch arena bytes per worker (per fiber)
     lum_allocator          *allocator;
     lum_lfq_t              *queue; // Per thread?
     lum_thread_t           *threads;
 } lum_scheduler_config_t;
 
+// Jobs that overflowed a full queue, oldest first, linked through Job::next
+typedef struct
+{
+    lum_mutex     lock;
+    Job          *head;
+    Job          *tail;
+    atomic_size_t count;
+} lum_job_spill_t;
+
+// Counters behind lum_scheduler_stats_t. Each worker owns one set; threads that are not workers
+// (submitters, helpers) share the scheduler's external_stats.
+typedef struct
+{
+    atomic_uint_least64_t jobs_executed;
+    atomic_uint_least64_t jobs_cancelled;
+    atomic_uint_least64_t steal_attempts;
+    atomic_uint_least64_t steals;
+    atomic_uint_least64_t idle_ns;
+    atomic_uint_least64_t idle_since; // Start of the current idle period, 0 while busy
+    atomic_uint_least64_t queue_full;
+    atomic_uint_least64_t max_queue_depth;
+} lum_stats_counters_t;
+
+// Snapshot returned by lum_scheduler_get_stats. Counters only grow from lum_scheduler_create on,
+// so rates come from the difference between two snapshots.
+typedef struct
+{
+    uint64_t jobs_executed;
+    uint64_t jobs_cancelled;  // Skipped because their cancel token was cancelled
+    uint64_t steal_attempts;  // Victim deques probed
+    uint64_t steals;          // Probes that returned a job
+    uint64_t idle_ns;         // Workers waiting for work
+    uint64_t busy_ns;         // Workers running (or looking for) jobs
+    uint64_t queue_full;      // Jobs that found their queue full (spilled or waited)
+    uint64_t max_queue_depth; // Deepest queue seen right after an enqueue
+} lum_scheduler_stats_t;
+
 typedef struct
 {
     lum_scheduler_config_t *config;
+    lum_worker_t           *workers;       // Per-worker state (deques, job pools)
+    lum_job_pool_t         *external_pool; // Jobs created on non-worker threads
+    lum_lfq_t              *queues[LUM_JOB_PRIORITY_COUNT]; // Shared queues by priority class
+    size_t                  queue_count; // LUM_JOB_PRIORITY_COUNT with LUM_QUEUE_PRIORITY, else 1
+    lum_job_spill_t         spills[LUM_JOB_PRIORITY_COUNT]; // Overflow of queues[i] (and nodes)
+    lum_lfq_t             **node_queues; // Per NUMA node, for jobs spawned by that node's workers
+    size_t                  node_count;
+    lum_fiber_t            *fibers;       // Fiber mode: every pooled fiber
+    lum_fiber_t            *free_fibers;  // Fibers not running or suspended in a job
+    lum_mutex               fiber_lock;   // Guards free_fibers
+    lum_lfq_t              *ready_fibers; // Suspended fibers whose counter has completed
+    lum_allocator         **fiber_scratch; // Scratch arena of each pooled fiber
+    unsigned               *fiber_help_depth; // Overflow help nesting of each pooled fiber
+    bool                    stealing;
+    size_t                  threads_started;
     lum_mutex               submission_lock;
-    lum_mutex               job_lock;
-    lum_cond_var            job_available;
-    lum_cond_var            job_done;
+    lum_eventcount          job_available; // Parked workers
+    lum_eventcount          job_done;      // Threads in lum_scheduler_wait_completion
     atomic_int              jobs_remaining;
     atomic_bool             running;
+    lum_stats_counters_t    external_stats; // Non-worker threads
+    lum_timer_wheel_t      *timers;     // Delayed and periodic jobs, advanced by the workers
+    lum_mutex               timer_lock; // Guards timers
+    atomic_uint_least64_t   next_timer; // When (ns) the wheel next needs a worker, or UINT64_MAX
+    uint64_t                stats_start;    // lum_time_now_ns at creation
+#ifdef USE_SCHEDULER_TRACE
+    uint64_t                trace_start; // Trace timestamps are relative to this
+#endif
 } lum_scheduler_t;
 
-// typedef struct {
-//     lum_scheduler_t* schedulers[MAX_SCHEDULERS];
-//     size_t count;
-// } lum_scheduler_manager_t;
+// Completion counter for a batch of jobs. Jobs are attached at submission time with
+// lum_scheduler_submit_counted and decrement it when they finish.
+struct lum_counter
+{
+    atomic_int     value;     // Jobs still pending
+    atomic_int     finishing; // Jobs between decrementing value and their last access
+    lum_eventcount waiters;   // Threads in lum_scheduler_wait_counter
+    _Atomic(lum_fiber_t *) fibers; // Fibers suspended in lum_scheduler_wait_counter
+};
+
+#define LUM_MAX_SCHEDULERS 8
+#define LUM_MAX_JOB_TAGS 32
+
+// Owns several schedulers, e.g. a low-latency pool on some cores and a background pool on
+// others (see lum_scheduler_config_t::cpus), and routes jobs to them by tag. Tags that were
+// never routed go to the first scheduler. Dependencies only work between jobs of one scheduler,
+// but jobs may submit to any of them.
+typedef struct
+{
+    lum_scheduler_t *schedulers[LUM_MAX_SCHEDULERS];
+    size_t           count;
+    uint8_t          routes[LUM_MAX_JOB_TAGS]; // Tag -> index into schedulers
+} lum_scheduler_manager_t;
 
 // API
 lum_scheduler_t *lum_scheduler_create(lum_scheduler_config_t *config);
 Job *lum_scheduler_create_job(lum_scheduler_t *scheduler, lum_thread_func function, void *data);
+// Create a job whose argument is copied into the job itself (at most LUM_JOB_PAYLOAD_SIZE
+// bytes); `function` receives a pointer to the copy, which lives until the job finishes.
+Job *lum_scheduler_create_job_inline(lum_scheduler_t *scheduler, lum_thread_func function,
+                                     const void *data, size_t size);
 void lum_scheduler_submit(lum_scheduler_t *scheduler, Job *job);
+void lum_scheduler_submit_counted(lum_scheduler_t *scheduler, Job *job, lum_counter_t *counter);
 void lum_scheduler_submit_batch(lum_scheduler_t *scheduler, Job **jobs, size_t count);
+void lum_scheduler_submit_batch_counted(lum_scheduler_t *scheduler, Job **jobs, size_t count,
+                                        lum_counter_t *counter);
+// Submit job once delay_ms have passed (1ms resolution). It counts as pending for
+// lum_scheduler_wait_completion from now on.
+void lum_scheduler_submit_after(lum_scheduler_t *scheduler, Job *job, uint32_t delay_ms);
+// Run function(data) as a new job every period_ms, the first time period_ms from now. Returns
+// NULL when out of memory.
+lum_job_timer_t *lum_scheduler_submit_periodic(lum_scheduler_t *scheduler,
+                                               lum_thread_func function, void *data,
+                                               uint32_t period_ms);
+// Stop a periodic job. A run that was already submitted still happens.
+void lum_scheduler_cancel_timer(lum_scheduler_t *scheduler, lum_job_timer_t *timer);
 void lum_scheduler_wait_completion(lum_scheduler_t *scheduler);
+// Linear scratch allocator for the job running on the calling thread, rewound when the job
+// returns, so its memory needs no freeing and must not outlive the job. Each worker has its own
+// (each fiber in fiber mode, as jobs may move between workers), so allocating takes no lock.
+// NULL outside of workers, e.g. for jobs run by help_while_waiting callers; alloc returns NULL
+// once scratch_size bytes are in use.
+lum_allocator *lum_scheduler_scratch(void);
+// Wait until *counter drops to zero, executing queued jobs on the calling thread meanwhile.
+// The counter is decremented by the caller's own jobs.
+void lum_scheduler_wait_until(lum_scheduler_t *scheduler, atomic_int *counter);
+// Wait until every job submitted against counter has finished. Unrelated jobs may still be in
+// flight when this returns. Honours help_while_waiting, in which case the caller may pick up
+// unrelated (possibly long) jobs while it waits. In fiber mode a job calling this is suspended
+// instead and its worker moves on to other work; the job may resume on another worker.
+void lum_scheduler_wait_counter(lum_scheduler_t *scheduler, lum_counter_t *counter);
+// lum_scheduler_wait_counter that always runs queued jobs while it cannot suspend, regardless of
+// help_while_waiting. For callers that fork work and join it, like the parallel loops.
+void lum_scheduler_wait_counter_helping(lum_scheduler_t *scheduler, lum_counter_t *counter);
+
+void lum_counter_init(lum_counter_t *counter);
+// True once every job has finished and stopped touching the counter, so it may go out of scope
+bool lum_counter_done(lum_counter_t *counter);
 void lum_scheduler_destroy(lum_scheduler_t *scheduler);
 
+// Counters summed over all workers and other threads (max_queue_depth is the overall maximum)
+void lum_scheduler_get_stats(lum_scheduler_t *scheduler, lum_scheduler_stats_t *stats);
+// Counters of a single worker, false if `worker` is out of range
+bool lum_scheduler_get_worker_stats(lum_scheduler_t *scheduler, size_t worker,
+                                    lum_scheduler_stats_t *stats);
+
+// Write the workers' recent timelines (jobs, steals, parked periods) as Chrome trace_event JSON,
+// viewable in chrome://tracing or ui.perfetto.dev. Best called between frames. Returns false
+// when the library was built without USE_SCHEDULER_TRACE.
+bool lum_scheduler_trace_export(lum_scheduler_t *scheduler, FILE *file);
+
+// Scheduler manager
+void lum_scheduler_manager_init(lum_scheduler_manager_t *manager);
+// Create a scheduler owned by the manager (config must outlive it). NULL when the manager is full
+// or creation fails.
+lum_scheduler_t *lum_scheduler_manager_add(lum_scheduler_manager_t *manager,
+                                           lum_scheduler_config_t *config);
+// Send jobs tagged `tag` to `scheduler`, which must belong to the manager
+bool lum_scheduler_manager_route(lum_scheduler_manager_t *manager, uint32_t tag,
+                                 lum_scheduler_t *scheduler);
+// Scheduler handling `tag`, for the rest of the scheduler API
+lum_scheduler_t *lum_scheduler_manager_get(lum_scheduler_manager_t *manager, uint32_t tag);
+// Jobs must be created and submitted with the same tag
+Job *lum_scheduler_manager_create_job(lum_scheduler_manager_t *manager, uint32_t tag,
+                                      lum_thread_func function, void *data);
+void lum_scheduler_manager_submit(lum_scheduler_manager_t *manager, uint32_t tag, Job *job);
+// Wait until every scheduler is idle, including jobs they submitted to each other
+void lum_scheduler_manager_wait_completion(lum_scheduler_manager_t *manager);
+void lum_scheduler_manager_destroy(lum_scheduler_manager_t *manager);
+
 #endif // LUM_SCHEDULER_H
\ No newline at end of file
@@ -0,0 +1,270 @@
+#include "lum_task_graph.h"
+
+#include "../memory/allocators/mem_alloc.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <string.h>
+
+typedef struct
+{
+    Job               job; // Persistent job, relaunched every run
+    lum_thread_func   function;
+    void             *data;
+    lum_task_graph_t *graph;
+    atomic_int        remaining; // Unfinished predecessors in the current run
+    int               predecessor_count;
+    int               first_successor; // Into graph->successors
+    int               successor_count;
+} lum_task_node_t;
+
+struct lum_task_graph
+{
+    lum_allocator   *allocator;
+    lum_scheduler_t *scheduler; // Of the current launch
+    size_t           max_tasks;
+    size_t           max_dependencies;
+    size_t           task_count;
+    size_t           dependency_count;
+    bool             compiled;
+
+    // Recorded tasks, by id
+    lum_thread_func *functions;
+    void           **data;
+    int             *dependencies; // (before, after) pairs
+
+    // Compiled layout
+    lum_task_node_t *nodes;      // Topological order
+    int             *slots;      // Task id -> node index
+    int             *successors; // Node indices, packed per node
+    Job            **roots;      // Jobs without predecessors
+    size_t           root_count;
+};
+
+lum_task_graph_t *lum_task_graph_create(lum_allocator *allocator, size_t max_tasks,
+                                        size_t max_dependencies)
+{
+    if (!allocator || max_tasks == 0)
+        return NULL;
+
+    lum_task_graph_t *graph =
+        allocator->alloc(allocator, sizeof(lum_task_graph_t), _Alignof(lum_task_graph_t));
+    if (!graph)
+        return NULL;
+    memset(graph, 0, sizeof(*graph));
+    graph->allocator        = allocator;
+    graph->max_tasks        = max_tasks;
+    graph->max_dependencies = max_dependencies;
+
+    graph->functions = allocator->alloc(allocator, max_tasks * sizeof(lum_thread_func), 16);
+    graph->data      = allocator->alloc(allocator, max_tasks * sizeof(void *), 16);
+    graph->dependencies =
+        max_dependencies ? allocator->alloc(allocator, max_dependencies * 2 * sizeof(int), 16)
+                         : NULL;
+    if (!graph->functions || !graph->data || (max_dependencies && !graph->dependencies))
+    {
+        lum_task_graph_destroy(graph);
+        return NULL;
+    }
+    return graph;
+}
+
+void lum_task_graph_destroy(lum_task_graph_t *graph)
+{
+    if (!graph)
+        return;
+
+    lum_allocator *allocator = graph->allocator;
+    void          *blocks[]  = {graph->functions, graph->data,       graph->dependencies,
+                                graph->nodes,     graph->slots,      graph->successors,
+                                graph->roots};
+    for (size_t i = 0; i < sizeof(blocks) / sizeof(blocks[0]); i++)
+    {
+        if (blocks[i])
+            allocator->free(allocator, blocks[i]);
+    }
+    allocator->free(allocator, graph);
+}
+
+int lum_task_graph_add(lum_task_graph_t *graph, lum_thread_func function, void *data)
+{
+    if (!graph || !function || graph->compiled || graph->task_count >= graph->max_tasks)
+        return -1;
+
+    int id               = (int) graph->task_count++;
+    graph->functions[id] = function;
+    graph->data[id]      = data;
+    return id;
+}
+
+bool lum_task_graph_depend(lum_task_graph_t *graph, int before, int after)
+{
+    if (!graph || graph->compiled || graph->dependency_count >= graph->max_dependencies)
+        return false;
+    if (before < 0 || after < 0 || before == after || (size_t) before >= graph->task_count ||
+        (size_t) after >= graph->task_count)
+        return false;
+
+    graph->dependencies[2 * graph->dependency_count]     = before;
+    graph->dependencies[2 * graph->dependency_count + 1] = after;
+    graph->dependency_count++;
+    return true;
+}
+
+// Runs the task, then submits the successors it was the last predecessor of
+static void *task_graph_node_job(void *arg)
+{
+    lum_task_node_t  *node  = (lum_task_node_t *) arg;
+    lum_task_graph_t *graph = node->graph;
+    node->function(node->data);
+
+    for (int i = 0; i < node->successor_count; i++)
+    {
+        lum_task_node_t *next = &graph->nodes[graph->successors[node->first_successor + i]];
+        if (atomic_fetch_sub_explicit(&next->remaining, 1, memory_order_acq_rel) == 1)
+            lum_scheduler_submit(graph->scheduler, &next->job);
+    }
+    return NULL;
+}
+
+bool lum_task_graph_compile(lum_task_graph_t *graph)
+{
+    if (!graph || graph->compiled)
+        return false;
+
+    lum_allocator *allocator = graph->allocator;
+    size_t         n         = graph->task_count;
+    size_t         m         = graph->dependency_count;
+
+    // Scratch: in-degrees, CSR adjacency by task id, Kahn queue (which becomes the order)
+    int *in_degree = allocator->alloc(allocator, (n + 1) * sizeof(int), 16);
+    int *offsets   = allocator->alloc(allocator, (n + 1) * sizeof(int), 16);
+    int *adjacency = allocator->alloc(allocator, (m + 1) * sizeof(int), 16);
+    int *order     = allocator->alloc(allocator, (n + 1) * sizeof(int), 16);
+
+    graph->nodes      = allocator->alloc(allocator, (n + 1) * sizeof(lum_task_node_t),
+                                         _Alignof(lum_task_node_t));
+    graph->slots      = allocator->alloc(allocator, (n + 1) * sizeof(int), 16);
+    graph->successors = allocator->alloc(allocator, (m + 1) * sizeof(int), 16);
+    graph->roots      = allocator->alloc(allocator, (n + 1) * sizeof(Job *), 16);
+
+    bool ok = in_degree && offsets && adjacency && order && graph->nodes && graph->slots &&
+              graph->successors && graph->roots;
+    if (ok)
+    {
+        memset(in_degree, 0, (n + 1) * sizeof(int));
+        memset(offsets, 0, (n + 1) * sizeof(int));
+        for (size_t e = 0; e < m; e++)
+        {
+            offsets[graph->dependencies[2 * e] + 1]++;
+            in_degree[graph->dependencies[2 * e + 1]]++;
+        }
+        for (size_t i = 0; i < n; i++)
+            offsets[i + 1] += offsets[i];
+
+        // Fill adjacency, using `order` as the per-task cursor for now
+        memcpy(order, offsets, n * sizeof(int));
+        for (size_t e = 0; e < m; e++)
+            adjacency[order[graph->dependencies[2 * e]]++] = graph->dependencies[2 * e + 1];
+
+        // Kahn's algorithm; roots come out first
+        size_t head = 0, tail = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            if (in_degree[i] == 0)
+                order[tail++] = (int) i;
+        }
+        graph->root_count = tail;
+        while (head < tail)
+        {
+            int task = order[head++];
+            for (int e = offsets[task]; e < offsets[task + 1]; e++)
+            {
+                if (--in_degree[adjacency[e]] == 0)
+                    order[tail++] = adjacency[e];
+            }
+        }
+        ok = tail == n; // Tasks left over sit on a cycle
+    }
+
+    if (ok)
+    {
+        memset(graph->nodes, 0, n * sizeof(lum_task_node_t));
+        for (size_t i = 0; i < n; i++)
+            graph->slots[order[i]] = (int) i;
+
+        // Lay out nodes and their successor lists in execution order
+        int packed = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            int              task = order[i];
+            lum_task_node_t *node = &graph->nodes[i];
+            node->function        = graph->functions[task];
+            node->data            = graph->data[task];
+            node->graph           = graph;
+            node->first_successor = packed;
+            node->successor_count = offsets[task + 1] - offsets[task];
+            for (int e = offsets[task]; e < offsets[task + 1]; e++)
+            {
+                graph->successors[packed++] = graph->slots[adjacency[e]];
+                graph->nodes[graph->slots[adjacency[e]]].predecessor_count++;
+            }
+
+            node->job.function = task_graph_node_job;
+            node->job.data     = node;
+            node->job.flags    = LUM_JOB_FLAG_PERSISTENT;
+            node->job.priority = LUM_JOB_PRIORITY_NORMAL;
+        }
+        for (size_t i = 0; i < graph->root_count; i++)
+            graph->roots[i] = &graph->nodes[i].job;
+        graph->compiled = true;
+    }
+
+    void *scratch[] = {in_degree, offsets, adjacency, order};
+    for (size_t i = 0; i < sizeof(scratch) / sizeof(scratch[0]); i++)
+    {
+        if (scratch[i])
+            allocator->free(allocator, scratch[i]);
+    }
+    return ok;
+}
+
+void lum_task_graph_set_data(lum_task_graph_t *graph, int task, void *data)
+{
+    assert(graph && task >= 0 && (size_t) task < graph->task_count);
+    if (graph->compiled)
+        graph->nodes[graph->slots[task]].data = data;
+    else
+        graph->data[task] = data;
+}
+
+void lum_task_graph_launch(lum_scheduler_t *scheduler, lum_task_graph_t *graph,
+                           lum_counter_t *counter)
+{
+    assert(graph && graph->compiled && "Compile the task graph before launching it");
+    if (!scheduler || graph->task_count == 0)
+        return;
+
+    // The counter covers the whole graph up front so it cannot reach zero between a task
+    // finishing and its successors being submitted
+    if (counter)
+        atomic_fetch_add_explicit(&counter->value, (int) graph->task_count, memory_order_relaxed);
+
+    graph->scheduler = scheduler;
+    for (size_t i = 0; i < graph->task_count; i++)
+    {
+        lum_task_node_t *node = &graph->nodes[i];
+        node->job.counter     = counter;
+        atomic_store_explicit(&node->remaining, node->predecessor_count, memory_order_relaxed);
+        atomic_store_explicit(&node->job.remaining_dependencies, 1, memory_order_relaxed);
+    }
+    lum_scheduler_submit_batch(scheduler, graph->roots, graph->root_count);
+}
+
+void lum_task_graph_run(lum_scheduler_t *scheduler, lum_task_graph_t *graph)
+{
+    lum_counter_t counter;
+    lum_counter_init(&counter);
+    lum_task_graph_launch(scheduler, graph, &counter);
+    lum_scheduler_wait_counter(scheduler, &counter);
+}
@@ -0,0 +1,38 @@
+#ifndef LUM_TASK_GRAPH_H
+#define LUM_TASK_GRAPH_H
+
+#include "lum_scheduler.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Task graph recorded once and launched many times (e.g. once per frame).
+//
+// Build: add tasks and dependencies, then compile. Compiling validates the graph (no cycles),
+// lays the tasks out in topological order with their successor lists packed next to each other
+// and embeds one persistent Job per task. Launching only resets counters and submits the roots,
+// nothing is allocated or rebuilt. A graph must not be relaunched before its previous run has
+// completed.
+typedef struct lum_task_graph lum_task_graph_t;
+
+lum_task_graph_t *lum_task_graph_create(lum_allocator *allocator, size_t max_tasks,
+                                        size_t max_dependencies);
+void              lum_task_graph_destroy(lum_task_graph_t *graph);
+
+// Returns the task id, or -1 when the graph is full or already compiled
+int  lum_task_graph_add(lum_task_graph_t *graph, lum_thread_func function, void *data);
+// `after` only starts once `before` has finished
+bool lum_task_graph_depend(lum_task_graph_t *graph, int before, int after);
+// Returns false if the dependencies contain a cycle
+bool lum_task_graph_compile(lum_task_graph_t *graph);
+
+// Change the data pointer of a task between launches
+void lum_task_graph_set_data(lum_task_graph_t *graph, int task, void *data);
+
+// Start every task; counter (optional) drops to zero once the last one has finished
+void lum_task_graph_launch(lum_scheduler_t *scheduler, lum_task_graph_t *graph,
+                           lum_counter_t *counter);
+// Launch and wait for completion
+void lum_task_graph_run(lum_scheduler_t *scheduler, lum_task_graph_t *graph);
+
+#endif // LUM_TASK_GRAPH_H
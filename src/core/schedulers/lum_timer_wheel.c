@@ -0,0 +1,141 @@
+#include "lum_timer_wheel.h"
+
+#define WHEEL_MASK (LUM_TIMER_WHEEL_SLOTS - 1)
+#define WHEEL_RANGE (1ull << (LUM_TIMER_WHEEL_BITS * LUM_TIMER_WHEEL_LEVELS))
+
+// Slots are circular lists around a sentinel node, so a timer can unlink itself
+static void wheel_unlink(lum_timer_t *timer)
+{
+    timer->prev->next = timer->next;
+    timer->next->prev = timer->prev;
+    timer->next       = NULL;
+    timer->prev       = NULL;
+}
+
+static void wheel_append(lum_timer_t *sentinel, lum_timer_t *timer)
+{
+    timer->prev          = sentinel->prev;
+    timer->next          = sentinel;
+    sentinel->prev->next = timer;
+    sentinel->prev       = timer;
+}
+
+// Put a timer on the lowest level whose range covers it
+static void wheel_place(lum_timer_wheel_t *wheel, lum_timer_t *timer)
+{
+    uint64_t expires = timer->expires > wheel->now ? timer->expires : wheel->now + 1;
+    if (expires - wheel->now >= WHEEL_RANGE)
+        expires = wheel->now + WHEEL_RANGE - 1; // Re-placed when its top level slot comes up
+
+    uint64_t delta = expires - wheel->now;
+    int      level = 0;
+    while (level < LUM_TIMER_WHEEL_LEVELS - 1 &&
+           delta >= (1ull << (LUM_TIMER_WHEEL_BITS * (level + 1))))
+        level++;
+
+    size_t slot = (size_t) (expires >> (LUM_TIMER_WHEEL_BITS * level)) & WHEEL_MASK;
+    wheel_append(&wheel->slots[level][slot], timer);
+}
+
+void lum_timer_wheel_init(lum_timer_wheel_t *wheel, uint64_t now)
+{
+    wheel->now   = now;
+    wheel->count = 0;
+    for (int level = 0; level < LUM_TIMER_WHEEL_LEVELS; level++)
+    {
+        for (size_t slot = 0; slot < LUM_TIMER_WHEEL_SLOTS; slot++)
+        {
+            wheel->slots[level][slot].next = &wheel->slots[level][slot];
+            wheel->slots[level][slot].prev = &wheel->slots[level][slot];
+        }
+    }
+}
+
+void lum_timer_wheel_add(lum_timer_wheel_t *wheel, lum_timer_t *timer)
+{
+    wheel_place(wheel, timer);
+    wheel->count++;
+}
+
+void lum_timer_wheel_remove(lum_timer_wheel_t *wheel, lum_timer_t *timer)
+{
+    wheel_unlink(timer);
+    wheel->count--;
+}
+
+lum_timer_t *lum_timer_wheel_advance(lum_timer_wheel_t *wheel, uint64_t tick)
+{
+    lum_timer_t  *fired = NULL;
+    lum_timer_t **tail  = &fired;
+    while (wheel->now < tick)
+    {
+        // Skip the ticks in which nothing fires or cascades
+        uint64_t next = lum_timer_wheel_next_tick(wheel);
+        if (next > tick)
+        {
+            wheel->now = tick;
+            break;
+        }
+        uint64_t now = wheel->now = next;
+
+        // Cascade the slots of every level the ones below it just wrapped into, top down
+        int top = 0;
+        while (top < LUM_TIMER_WHEEL_LEVELS - 1 &&
+               (now & ((1ull << (LUM_TIMER_WHEEL_BITS * (top + 1))) - 1)) == 0)
+            top++;
+        for (int level = top; level > 0; level--)
+        {
+            lum_timer_t *sentinel =
+                &wheel->slots[level][(now >> (LUM_TIMER_WHEEL_BITS * level)) & WHEEL_MASK];
+            while (sentinel->next != sentinel)
+            {
+                lum_timer_t *timer = sentinel->next;
+                wheel_unlink(timer);
+                if (timer->expires > now)
+                {
+                    wheel_place(wheel, timer);
+                    continue;
+                }
+                wheel->count--;
+                *tail = timer;
+                tail  = &timer->next;
+            }
+        }
+
+        lum_timer_t *sentinel = &wheel->slots[0][now & WHEEL_MASK];
+        while (sentinel->next != sentinel)
+        {
+            lum_timer_t *timer = sentinel->next;
+            wheel_unlink(timer);
+            wheel->count--;
+            *tail = timer;
+            tail  = &timer->next;
+        }
+    }
+    *tail = NULL;
+    return fired;
+}
+
+uint64_t lum_timer_wheel_next_tick(const lum_timer_wheel_t *wheel)
+{
+    if (wheel->count == 0)
+        return UINT64_MAX;
+
+    uint64_t next = UINT64_MAX;
+    for (int level = 0; level < LUM_TIMER_WHEEL_LEVELS; level++)
+    {
+        int      shift = LUM_TIMER_WHEEL_BITS * level;
+        uint64_t base  = wheel->now >> shift;
+        for (uint64_t i = 1; i <= LUM_TIMER_WHEEL_SLOTS; i++)
+        {
+            const lum_timer_t *sentinel = &wheel->slots[level][(base + i) & WHEEL_MASK];
+            if (sentinel->next != sentinel)
+            {
+                uint64_t tick = (base + i) << shift; // Fires (level 0) or cascades
+                next          = tick < next ? tick : next;
+                break;
+            }
+        }
+    }
+    return next;
+}
@@ -0,0 +1,43 @@
+#ifndef LUM_TIMER_WHEEL_H
+#define LUM_TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Hierarchical timer wheel (Varghese & Lauck). Level 0 has one slot per tick, every level above
+// covers 64 times the range of the one below; timers move down a level whenever the wheel
+// reaches their slot, so add/remove are O(1) and advancing is O(1) per tick plus cascades.
+// Not thread safe: the owner serializes access. Slots point into the wheel, so it must not move
+// once initialized.
+#define LUM_TIMER_WHEEL_BITS 6
+#define LUM_TIMER_WHEEL_SLOTS (1u << LUM_TIMER_WHEEL_BITS)
+#define LUM_TIMER_WHEEL_LEVELS 4 // 2^24 ticks (~4.6 hours at 1ms), longer timers wait up top
+
+// Intrusive node: embed it in the timer's owner
+typedef struct lum_timer
+{
+    struct lum_timer *next;
+    struct lum_timer *prev;
+    uint64_t          expires; // Tick the timer fires at
+} lum_timer_t;
+
+typedef struct
+{
+    uint64_t     now; // Last tick processed
+    size_t       count;
+    lum_timer_t  slots[LUM_TIMER_WHEEL_LEVELS][LUM_TIMER_WHEEL_SLOTS]; // List sentinels
+} lum_timer_wheel_t;
+
+void lum_timer_wheel_init(lum_timer_wheel_t *wheel, uint64_t now);
+// Timers already due fire on the next tick
+void lum_timer_wheel_add(lum_timer_wheel_t *wheel, lum_timer_t *timer);
+// Only for timers still in the wheel
+void lum_timer_wheel_remove(lum_timer_wheel_t *wheel, lum_timer_t *timer);
+// Process every tick up to `tick` and return the timers that fired, oldest first, linked
+// through `next`. They are no longer in the wheel.
+lum_timer_t *lum_timer_wheel_advance(lum_timer_wheel_t *wheel, uint64_t tick);
+// Earliest tick at which advancing can fire or cascade a timer, UINT64_MAX when empty
+uint64_t lum_timer_wheel_next_tick(const lum_timer_wheel_t *wheel);
+
+#endif // LUM_TIMER_WHEEL_H
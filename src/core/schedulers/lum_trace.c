@@ -0,0 +1,92 @@
+#include "lum_trace.h"
+
+#include "math/math_bits.h"
+
+#include <inttypes.h>
+
+bool lum_trace_buffer_init(lum_trace_buffer_t *buffer, size_t capacity, lum_allocator *allocator)
+{
+    if (!buffer || !allocator || capacity < 2)
+        return false;
+
+    if (!lum_is_power_of_two(capacity))
+        capacity = lum_next_power_of_two((uint32_t) capacity);
+
+    buffer->mask      = capacity - 1;
+    buffer->allocator = allocator;
+    buffer->events    = allocator->alloc(allocator, capacity * sizeof(lum_trace_event_t), 64);
+    if (!buffer->events)
+        return false;
+
+    for (size_t i = 0; i < capacity; i++)
+    {
+        atomic_init(&buffer->events[i].header, 0);
+        atomic_init(&buffer->events[i].argument, 0);
+    }
+    atomic_init(&buffer->head, 0);
+    return true;
+}
+
+void lum_trace_buffer_destroy(lum_trace_buffer_t *buffer)
+{
+    if (!buffer || !buffer->events)
+        return;
+    buffer->allocator->free(buffer->allocator, buffer->events);
+    buffer->events = NULL;
+}
+
+void lum_trace_write_json(const lum_trace_buffer_t *buffer, FILE *file, int tid, uint64_t start,
+                          bool *first)
+{
+    if (!buffer || !buffer->events)
+        return;
+
+    size_t capacity = buffer->mask + 1;
+    size_t head     = atomic_load_explicit(&buffer->head, memory_order_acquire);
+    for (size_t i = head > capacity ? head - capacity : 0; i < head; i++)
+    {
+        const lum_trace_event_t *event = &buffer->events[i & buffer->mask];
+        uint64_t header   = atomic_load_explicit(&event->header, memory_order_relaxed);
+        uint64_t argument = atomic_load_explicit(&event->argument, memory_order_relaxed);
+
+        // The worker may have lapped the reader: the slot being written is `head - capacity`
+        atomic_thread_fence(memory_order_acquire);
+        if (i + capacity <= atomic_load_explicit(&buffer->head, memory_order_relaxed))
+            continue;
+
+        double ts = (double) ((int64_t) ((header >> 8) - start)) / 1000.0; // Microseconds
+        fprintf(file, "%s\n{\"pid\":0,\"tid\":%d,\"ts\":%.3f,", *first ? "" : ",", tid, ts);
+        *first = false;
+        switch ((lum_trace_event_type_t) (header & 0xff))
+        {
+        case LUM_TRACE_JOB_BEGIN:
+            fprintf(file,
+                    "\"ph\":\"B\",\"cat\":\"job\",\"name\":\"job\","
+                    "\"args\":{\"job\":\"0x%" PRIx64 "\"}}",
+                    argument);
+            break;
+        case LUM_TRACE_JOB_END:
+            fprintf(file, "\"ph\":\"E\",\"cat\":\"job\",\"name\":\"job\"}");
+            break;
+        case LUM_TRACE_JOB_SUSPEND:
+            fprintf(file, "\"ph\":\"E\",\"cat\":\"job\",\"name\":\"job\","
+                          "\"args\":{\"suspended\":true}}");
+            break;
+        case LUM_TRACE_JOB_RESUME:
+            fprintf(file, "\"ph\":\"B\",\"cat\":\"job\",\"name\":\"job (resumed)\"}");
+            break;
+        case LUM_TRACE_STEAL:
+            fprintf(file, "\"ph\":\"i\",\"s\":\"t\",\"cat\":\"scheduler\",\"name\":\"steal\","
+                          "\"args\":{\"victim\":%" PRIu64 "}}",
+                    argument);
+            break;
+        case LUM_TRACE_PARK:
+            fprintf(file, "\"ph\":\"B\",\"cat\":\"idle\",\"name\":\"parked\"}");
+            break;
+        case LUM_TRACE_WAKE:
+        default:
+            fprintf(file, "\"ph\":\"E\",\"cat\":\"idle\",\"name\":\"parked\"}");
+            break;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef LUM_TRACE_H
+#define LUM_TRACE_H
+
+#include "allocators/mem_alloc.h"
+#include "platform.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Scheduler timeline tracing. The scheduler only records events when built with
+// USE_SCHEDULER_TRACE (cmake -DUSE_SCHEDULER_TRACE=ON); otherwise its hooks compile to nothing.
+#define LUM_TRACE_CAPACITY 16384 // Events per worker, the oldest are overwritten first
+
+typedef enum
+{
+    LUM_TRACE_JOB_BEGIN,
+    LUM_TRACE_JOB_END,
+    LUM_TRACE_JOB_SUSPEND, // Fiber mode: the running job parked on a counter
+    LUM_TRACE_JOB_RESUME,  // Fiber mode: a parked job continues on this worker
+    LUM_TRACE_STEAL,       // Argument: victim worker index
+    LUM_TRACE_PARK,
+    LUM_TRACE_WAKE
+} lum_trace_event_type_t;
+
+// Both words are atomics so the buffer can be read while its worker keeps recording
+typedef struct
+{
+    atomic_uint_least64_t header;   // Timestamp (ns) << 8 | lum_trace_event_type_t
+    atomic_uint_least64_t argument; // Job address or victim index
+} lum_trace_event_t;
+
+// Single-writer ring of events. Only the owning worker records, anyone may read.
+typedef struct
+{
+    atomic_size_t      head; // Events recorded so far
+    size_t             mask; // Capacity - 1, capacity is a power of two
+    lum_trace_event_t *events;
+    lum_allocator     *allocator;
+} lum_trace_buffer_t;
+
+bool lum_trace_buffer_init(lum_trace_buffer_t *buffer, size_t capacity, lum_allocator *allocator);
+void lum_trace_buffer_destroy(lum_trace_buffer_t *buffer);
+
+static inline void lum_trace_record(lum_trace_buffer_t *buffer, lum_trace_event_type_t type,
+                                    uint64_t argument)
+{
+    size_t             head  = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    lum_trace_event_t *event = &buffer->events[head & buffer->mask];
+    atomic_store_explicit(&event->header, (lum_time_now_ns() << 8) | (uint64_t) type,
+                          memory_order_relaxed);
+    atomic_store_explicit(&event->argument, argument, memory_order_relaxed);
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+// Append the buffer's events as Chrome trace_event JSON objects (comma separated, without the
+// enclosing array) for thread `tid`, timestamps relative to `start`. `first` tracks whether a
+// separating comma is needed across calls. Events overwritten while reading are skipped.
+void lum_trace_write_json(const lum_trace_buffer_t *buffer, FILE *file, int tid, uint64_t start,
+                          bool *first);
+
+#endif // LUM_TRACE_H
@@ -0,0 +1,154 @@
+#if defined(__APPLE__)
+#define _XOPEN_SOURCE 700 // ucontext
+#define _DARWIN_C_SOURCE  // MAP_ANONYMOUS
+#elif !defined(_WIN32)
+#define _GNU_SOURCE
+#endif
+#include "lum_fiber.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef PLATFORM_WINDOWS
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+// ThreadSanitizer has to be told about every stack switch
+#if defined(__SANITIZE_THREAD__)
+#define LUM_FIBER_TSAN
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define LUM_FIBER_TSAN
+#endif
+#endif
+#ifdef LUM_FIBER_TSAN
+#include <sanitizer/tsan_interface.h>
+#endif
+
+#ifdef PLATFORM_WINDOWS
+static void WINAPI fiber_trampoline(void *arg)
+{
+    lum_fiber_t *fiber = (lum_fiber_t *) arg;
+    fiber->entry(fiber->arg);
+    abort(); // Entry functions switch away instead of returning
+}
+#else
+// makecontext only passes ints, so the fiber pointer arrives in two halves
+static void fiber_trampoline(unsigned int lo, unsigned int hi)
+{
+    lum_fiber_t *fiber = (lum_fiber_t *) (uintptr_t) (((uint64_t) hi << 32) | lo);
+    fiber->entry(fiber->arg);
+    abort(); // Entry functions switch away instead of returning
+}
+
+static size_t fiber_round_up(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+#endif
+
+bool lum_fiber_create(lum_fiber_t *fiber, size_t stack_size, lum_fiber_func entry, void *arg)
+{
+    memset(fiber, 0, sizeof(*fiber));
+    fiber->entry = entry;
+    fiber->arg   = arg;
+
+#ifdef PLATFORM_WINDOWS
+    fiber->context = CreateFiber(stack_size, fiber_trampoline, fiber);
+    if (!fiber->context)
+        return false;
+#else
+    // Layout: [guard page][stack][ucontext_t], the stack grows down towards the guard
+    long   page_size    = sysconf(_SC_PAGESIZE);
+    size_t page         = page_size > 0 ? (size_t) page_size : 4096;
+    size_t stack        = fiber_round_up(stack_size, page);
+    fiber->mapping_size = page + stack + fiber_round_up(sizeof(ucontext_t), page);
+    fiber->mapping      = mmap(NULL, fiber->mapping_size, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (fiber->mapping == MAP_FAILED)
+    {
+        fiber->mapping = NULL;
+        return false;
+    }
+    mprotect(fiber->mapping, page, PROT_NONE);
+
+    ucontext_t *context = (ucontext_t *) ((char *) fiber->mapping + page + stack);
+    if (getcontext(context) != 0)
+    {
+        munmap(fiber->mapping, fiber->mapping_size);
+        fiber->mapping = NULL;
+        return false;
+    }
+    context->uc_stack.ss_sp   = (char *) fiber->mapping + page;
+    context->uc_stack.ss_size = stack;
+    context->uc_link          = NULL;
+
+    uint64_t self = (uint64_t) (uintptr_t) fiber;
+    makecontext(context, (void (*)(void)) fiber_trampoline, 2, (unsigned int) (self & 0xffffffffu),
+                (unsigned int) (self >> 32));
+    fiber->context = context;
+#endif
+
+#ifdef LUM_FIBER_TSAN
+    fiber->tsan_fiber = __tsan_create_fiber(0);
+#endif
+    return true;
+}
+
+void lum_fiber_destroy(lum_fiber_t *fiber)
+{
+    if (!fiber || !fiber->context)
+        return;
+#ifdef LUM_FIBER_TSAN
+    __tsan_destroy_fiber(fiber->tsan_fiber);
+#endif
+#ifdef PLATFORM_WINDOWS
+    DeleteFiber(fiber->context);
+#else
+    munmap(fiber->mapping, fiber->mapping_size);
+    fiber->mapping = NULL;
+#endif
+    fiber->context = NULL;
+}
+
+bool lum_fiber_from_thread(lum_fiber_t *fiber)
+{
+    memset(fiber, 0, sizeof(*fiber));
+#ifdef PLATFORM_WINDOWS
+    fiber->context = ConvertThreadToFiber(NULL);
+#else
+    fiber->context = malloc(sizeof(ucontext_t)); // Filled in by the first switch away
+#endif
+#ifdef LUM_FIBER_TSAN
+    fiber->tsan_fiber = __tsan_get_current_fiber();
+#endif
+    return fiber->context != NULL;
+}
+
+void lum_fiber_to_thread(lum_fiber_t *fiber)
+{
+    if (!fiber || !fiber->context)
+        return;
+#ifdef PLATFORM_WINDOWS
+    ConvertFiberToThread();
+#else
+    free(fiber->context);
+#endif
+    fiber->context = NULL;
+}
+
+void lum_fiber_switch(lum_fiber_t *from, lum_fiber_t *to)
+{
+#ifdef LUM_FIBER_TSAN
+    __tsan_switch_to_fiber(to->tsan_fiber, 0);
+#endif
+#ifdef PLATFORM_WINDOWS
+    (void) from;
+    SwitchToFiber(to->context);
+#else
+    swapcontext((ucontext_t *) from->context, (ucontext_t *) to->context);
+#endif
+}
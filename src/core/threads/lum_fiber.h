@@ -0,0 +1,35 @@
+#ifndef LUMEN_FIBER_H
+#define LUMEN_FIBER_H
+
+#include "../platform.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Fiber entry point. Must never return: switch to another fiber instead.
+typedef void (*lum_fiber_func)(void *arg);
+
+// User-space execution context with its own stack (ucontext on POSIX, Win32 fibers on Windows).
+// Stacks are mapped with a guard page below them so an overflow faults instead of corrupting.
+typedef struct lum_fiber
+{
+    void             *context;    // Platform context (ucontext_t or fiber handle)
+    void             *mapping;    // Stack mapping, NULL for thread fibers
+    size_t            mapping_size;
+    void             *tsan_fiber; // ThreadSanitizer fiber handle (sanitized builds only)
+    lum_fiber_func    entry;
+    void             *arg;
+    struct lum_fiber *next;       // Free list / wait list link for the owner of the fiber
+} lum_fiber_t;
+
+bool lum_fiber_create(lum_fiber_t *fiber, size_t stack_size, lum_fiber_func entry, void *arg);
+void lum_fiber_destroy(lum_fiber_t *fiber);
+
+// Turn the calling thread into a fiber so it can switch to others and be switched back to.
+bool lum_fiber_from_thread(lum_fiber_t *fiber);
+void lum_fiber_to_thread(lum_fiber_t *fiber);
+
+// Save the current context into `from` and resume `to`. Returns when something switches back.
+void lum_fiber_switch(lum_fiber_t *from, lum_fiber_t *to);
+
+#endif
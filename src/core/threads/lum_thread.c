@@ -1,14 +1,158 @@
+#define _GNU_SOURCE // pthread_setaffinity_np
 #include "lum_thread.h"
 
 #include "../memory/allocators/mem_pool.h"
 
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+bool lum_job_add_dependency(Job *parent, Job *child)
+{
+    if (!parent || !child || parent == child)
+        return false;
+    if (parent->successor_count >= LUM_JOB_MAX_SUCCESSORS)
+        return false;
+
+    atomic_fetch_add(&child->remaining_dependencies, 1);
+    parent->successors[parent->successor_count++] = child;
+    return true;
+}
+
+void lum_job_set_priority(Job *job, lum_job_priority_t priority)
+{
+    assert(priority >= 0 && priority < LUM_JOB_PRIORITY_COUNT);
+    job->priority = priority;
+}
+
+bool lum_job_then(Job *job, Job *next)
+{
+    if (!job || !next || job == next || job->continuation)
+        return false;
+    // next keeps its submission hold, job's completion drops it
+    job->continuation = next;
+    return true;
+}
+
+void lum_job_set_cancel_token(Job *job, lum_cancel_token_t *token)
+{
+    job->cancel = token;
+}
+
+void lum_cancel_token_init(lum_cancel_token_t *token)
+{
+    atomic_init(&token->cancelled, false);
+}
+
+void lum_cancel_token_cancel(lum_cancel_token_t *token)
+{
+    atomic_store_explicit(&token->cancelled, true, memory_order_release);
+}
+
+bool lum_cancel_token_cancelled(lum_cancel_token_t *token)
+{
+    return atomic_load_explicit(&token->cancelled, memory_order_acquire);
+}
+
+#ifdef PLATFORM_LINUX
+// Parse a sysfs CPU list such as "0-3,8-11". Returns the number of CPUs read, -1 if missing.
+static int topology_read_cpulist(const char *path, int *cpus, int max)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return -1;
+
+    int count = 0, first, last;
+    while (fscanf(file, "%d", &first) == 1)
+    {
+        last     = first;
+        int next   = fgetc(file);
+        if (next == '-')
+        {
+            if (fscanf(file, "%d", &last) != 1)
+                break;
+            next = fgetc(file);
+        }
+        for (int cpu = first; cpu <= last && count < max; cpu++)
+            cpus[count++] = cpu;
+        if (next != ',')
+            break;
+    }
+    fclose(file);
+    return count;
+}
+#endif
+
+void lum_topology_query(lum_topology_t *topology)
+{
+    topology->cpu_count      = 0;
+    topology->node_count     = 0;
+    topology->node_offset[0] = 0;
+
+#ifdef PLATFORM_LINUX
+    // Node ids may be sparse; memory-only nodes have an empty cpulist and are skipped
+    char path[64];
+    for (int id = 0; id < 4 * LUM_MAX_NUMA_NODES && topology->node_count < LUM_MAX_NUMA_NODES;
+         id++)
+    {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", id);
+        int count = topology_read_cpulist(path, topology->cpus + topology->cpu_count,
+                                          LUM_MAX_CPUS - topology->cpu_count);
+        if (count <= 0)
+            continue;
+        topology->cpu_count += count;
+        topology->node_offset[++topology->node_count] = topology->cpu_count;
+    }
+    if (topology->node_count > 0)
+        return;
+#endif
+
+    // No NUMA information: one node with every online CPU
+    int count;
+#ifdef PLATFORM_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    count = (int) info.dwNumberOfProcessors;
+#else
+    count = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    if (count < 1)
+        count = 1;
+    if (count > LUM_MAX_CPUS)
+        count = LUM_MAX_CPUS;
+    for (int i = 0; i < count; i++)
+        topology->cpus[i] = i;
+    topology->cpu_count      = count;
+    topology->node_count     = 1;
+    topology->node_offset[1] = count;
+}
+
+bool lum_thread_set_affinity(lum_thread thread, int cpu)
+{
+    if (cpu < 0)
+        return false;
+#if defined(PLATFORM_LINUX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+#elif defined(PLATFORM_WINDOWS)
+    if (cpu >= 64)
+        return false; // Processor groups are not handled
+    return SetThreadAffinityMask(thread, (DWORD_PTR) 1 << cpu) != 0;
+#else
+    (void) thread; // macOS only offers affinity hints
+    return false;
+#endif
+}
+
 void lum_thread_init(lum_thread_t *worker, int id, lum_thread_func func, void *arg)
 {
     atomic_store(&worker->running, true);
+    worker->cpu    = -1;
     worker->thread = lum_thread_create(func, arg);
+    if (worker->type != LUM_THREAD_TASK && lum_thread_set_affinity(worker->thread, id))
+        worker->cpu = id;
 }
 
 // Stop worker thread (graceful shutdown)
@@ -7,29 +7,104 @@
 #include <stdbool.h>
 
 typedef struct lum_allocator lum_allocator;
+typedef struct lum_job_pool  lum_job_pool_t;
+typedef struct lum_counter   lum_counter_t;
+
+#define LUM_JOB_MAX_SUCCESSORS 8
+#define LUM_JOB_PAYLOAD_SIZE 32 // Bytes of argument data a job can carry inline
+
+// Job flags
+#define LUM_JOB_FLAG_HEAP (1u << 0)       // Allocated from the pool's fallback allocator
+#define LUM_JOB_FLAG_PERSISTENT (1u << 1) // Owned by the caller (e.g. a task graph), never freed
+
+// Priority classes, drained in this order by schedulers using LUM_QUEUE_PRIORITY
+typedef enum
+{
+    LUM_JOB_PRIORITY_CRITICAL,   // On the frame's critical path
+    LUM_JOB_PRIORITY_NORMAL,     // Default
+    LUM_JOB_PRIORITY_BACKGROUND, // Streaming, decompression, ... Runs when nothing else is queued
+    LUM_JOB_PRIORITY_COUNT
+} lum_job_priority_t;
+
+// Shared by the jobs of one operation. Once cancelled, those that have not started yet are
+// skipped; they still count as finished for counters, successors and continuations.
+typedef struct
+{
+    atomic_bool cancelled;
+} lum_cancel_token_t;
 
 typedef struct Job
 {
     lum_thread_func function;
     void           *data;
-    atomic_int      remaining_dependencies;
+    atomic_int      remaining_dependencies; // Unfinished parents, +1 until the job is submitted
+    int             successor_count;
+    struct Job     *successors[LUM_JOB_MAX_SUCCESSORS]; // Jobs released when this one finishes
+    lum_counter_t  *counter; // Decremented when the job finishes (optional)
+    lum_job_pool_t *pool;    // Owning job pool
+    struct Job     *next;    // Free list / batch link while free, spill list link while queued
+    struct Job     *continuation; // Submitted when this job finishes, see lum_job_then
+    lum_cancel_token_t *cancel;   // Skip the job if cancelled before it starts (optional)
+    uint32_t        flags;
+    lum_job_priority_t priority; // Queue class (LUM_QUEUE_PRIORITY only)
+    _Alignas(16) unsigned char payload[LUM_JOB_PAYLOAD_SIZE]; // Inline copy of `data`
 } Job;
 
 typedef enum
 {
     LUM_THREAD_TASK,
-    LUM_THREAD_NUMA
+    LUM_THREAD_NUMA,
+    LUM_THREAD_PINNED // Pinned to a CPU picked by the caller
 } lum_thread_type;
 
 typedef struct
 {
     lum_thread_type type;
     lum_thread      thread;
-    int             numa_node; // Only used for NUMA threads
+    int             numa_node; // Only used for NUMA and pinned threads
+    int             cpu;       // CPU the thread is pinned to, -1 when unpinned
     atomic_bool     running;
     // lum_allocator* allocator; // unused?
 } lum_thread_t;
 
+#define LUM_MAX_CPUS 256
+#define LUM_MAX_NUMA_NODES 16
+
+// CPU topology. CPUs are grouped by NUMA node: node n owns
+// cpus[node_offset[n]] .. cpus[node_offset[n + 1] - 1].
+typedef struct
+{
+    int cpu_count;
+    int node_count;
+    int cpus[LUM_MAX_CPUS];
+    int node_offset[LUM_MAX_NUMA_NODES + 1];
+} lum_topology_t;
+
+// Declare that child may only run after parent has finished. Both jobs must be created but not
+// yet submitted. Returns false when parent already has LUM_JOB_MAX_SUCCESSORS successors.
+bool lum_job_add_dependency(Job *parent, Job *child);
+// Set the priority class of a job that has not been submitted yet
+void lum_job_set_priority(Job *job, lum_job_priority_t priority);
+// Run next once job has finished, on the same worker and without going through a queue (unless
+// its priority class differs). next must not be submitted: job's completion submits it, adding
+// it to job's counter and cancel token when it has none of its own. Chains of continuations only
+// need their first job submitted. Returns false when job already has a continuation.
+bool lum_job_then(Job *job, Job *next);
+// Skip job if token is cancelled before the job starts. Set before submitting.
+void lum_job_set_cancel_token(Job *job, lum_cancel_token_t *token);
+
+void lum_cancel_token_init(lum_cancel_token_t *token);
+void lum_cancel_token_cancel(lum_cancel_token_t *token);
+bool lum_cancel_token_cancelled(lum_cancel_token_t *token);
+
+// Read the CPU/NUMA layout (/sys/devices/system/node on Linux). Falls back to a single node
+// holding every online CPU when the layout is not available.
+void lum_topology_query(lum_topology_t *topology);
+// Pin a thread to one CPU. Returns false when unsupported or refused by the OS.
+bool lum_thread_set_affinity(lum_thread thread, int cpu);
+
+// Start a worker thread. NUMA and pinned threads are pinned to CPU `id`; task threads are left
+// unpinned.
 void lum_thread_init(lum_thread_t *worker, int id, lum_thread_func func, void *arg);
 void lum_thread_shutdown(lum_thread_t *worker);
 
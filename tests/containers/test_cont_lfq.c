@@ -22,7 +22,7 @@ static bool test_basic_operations()
     // Allocate queue
     lum_allocator *allocator = lum_create_default_allocator();
     assert(allocator != NULL);
-    lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), 16);
+    lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), _Alignof(lum_lfq_t));
     lum_lfq_init(queue, TEST_CAPACITY, allocator);
 
     TestItem item1 = {42};
@@ -60,7 +60,7 @@ static bool test_queue_full()
     // Allocate queue
     lum_allocator *allocator = lum_create_default_allocator();
     assert(allocator != NULL);
-    lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), 16);
+    lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), _Alignof(lum_lfq_t));
     lum_lfq_init(queue, TEST_CAPACITY, allocator);
 
     TestItem items[TEST_CAPACITY];
@@ -97,7 +97,7 @@ static bool benchmark_queue()
     // Allocate queue
     lum_allocator *allocator = lum_create_default_allocator();
     assert(allocator != NULL);
-    lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), 16);
+    lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), _Alignof(lum_lfq_t));
     lum_lfq_init(queue, TEST_CAPACITY, allocator);
 
     TestItem items[NUM_OPERATIONS];
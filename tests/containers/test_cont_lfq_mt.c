@@ -37,6 +37,7 @@ void *producer_thread(void *arg)
         item->value    = i + (args->thread_id * args->num_items);
         lum_lfq_enqueue(args->queue, item);
     }
+    return NULL;
 }
 
 void *consumer_thread(void *arg)
@@ -49,6 +50,7 @@ void *consumer_thread(void *arg)
         //args->allocator->free(args->allocator, item);
         atomic_fetch_add(&jobs_executed, 1);
     }
+    return NULL;
 }
 
 
@@ -58,7 +60,7 @@ static bool test_split_production_consumption()
     lum_allocator *allocator = lum_create_default_allocator();
     assert(allocator != NULL);
 
-    lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), 16);
+    lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), _Alignof(lum_lfq_t));
     if (!queue) 
         return false;
     memset(queue, 0, sizeof(lum_lfq_t));
@@ -106,9 +108,127 @@ static bool test_split_production_consumption()
     return true;
 }
 
+#define STRESS_PRODUCERS 4
+#define STRESS_CONSUMERS 4
+#define STRESS_ITEMS 50000 // Per producer
+#define STRESS_CAPACITY 256 // Small on purpose: producers keep wrapping around
+#define STRESS_BULK 8
+
+typedef struct
+{
+    lum_lfq_t   *queue;
+    int          thread_id;
+    atomic_int  *consumed;
+    atomic_uchar *seen;
+} StressArgs;
+
+// Items are encoded as (value + 1) so NULL stays the empty marker
+static void *stress_producer(void *arg)
+{
+    StressArgs *args = (StressArgs *) arg;
+    uintptr_t   base = (uintptr_t) args->thread_id * STRESS_ITEMS;
+
+    // Odd producers publish in bulk to exercise the single-CAS reservation path
+    if (args->thread_id & 1)
+    {
+        void *items[STRESS_BULK];
+        for (int i = 0; i < STRESS_ITEMS; i += STRESS_BULK)
+        {
+            size_t count = STRESS_ITEMS - i < STRESS_BULK ? STRESS_ITEMS - i : STRESS_BULK;
+            for (size_t j = 0; j < count; j++)
+                items[j] = (void *) (base + i + j + 1);
+
+            size_t pushed = 0;
+            while (pushed < count)
+            {
+                size_t n = lum_lfq_enqueue_bulk(args->queue, items + pushed, count - pushed);
+                if (n == 0)
+                    lum_thread_yield();
+                pushed += n;
+            }
+        }
+        return NULL;
+    }
+
+    for (int i = 0; i < STRESS_ITEMS; i++)
+    {
+        while (!lum_lfq_enqueue(args->queue, (void *) (base + i + 1)))
+            lum_thread_yield();
+    }
+    return NULL;
+}
+
+static void *stress_consumer(void *arg)
+{
+    StressArgs *args = (StressArgs *) arg;
+    while (atomic_load_explicit(args->consumed, memory_order_relaxed) <
+           STRESS_PRODUCERS * STRESS_ITEMS)
+    {
+        void *item = lum_lfq_dequeue(args->queue);
+        if (!item)
+        {
+            lum_thread_yield();
+            continue;
+        }
+        atomic_fetch_add_explicit(&args->seen[(uintptr_t) item - 1], 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(args->consumed, 1, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+// Producers and consumers run concurrently; every item must come out exactly once
+static bool test_mpmc_stress()
+{
+    enum { TOTAL = STRESS_PRODUCERS * STRESS_ITEMS };
+
+    lum_allocator *allocator = lum_create_default_allocator();
+    ASSERT_NOT_NULL(allocator);
+    lum_lfq_t *queue = allocator->alloc(allocator, sizeof(lum_lfq_t), _Alignof(lum_lfq_t));
+    ASSERT_NOT_NULL(queue);
+    ASSERT_TRUE(lum_lfq_init(queue, STRESS_CAPACITY, allocator));
+
+    atomic_uchar *seen = calloc(TOTAL, sizeof(atomic_uchar));
+    ASSERT_NOT_NULL(seen);
+    atomic_int consumed = 0;
+
+    lum_thread producers[STRESS_PRODUCERS];
+    lum_thread consumers[STRESS_CONSUMERS];
+    StressArgs args[STRESS_PRODUCERS + STRESS_CONSUMERS];
+
+    double start = get_wall_time();
+    for (int i = 0; i < STRESS_PRODUCERS + STRESS_CONSUMERS; i++)
+        args[i] = (StressArgs){queue, i, &consumed, seen};
+    for (int i = 0; i < STRESS_CONSUMERS; i++)
+        consumers[i] = lum_thread_create(stress_consumer, &args[STRESS_PRODUCERS + i]);
+    for (int i = 0; i < STRESS_PRODUCERS; i++)
+        producers[i] = lum_thread_create(stress_producer, &args[i]);
+
+    for (int i = 0; i < STRESS_PRODUCERS; i++)
+        lum_thread_join(producers[i]);
+    for (int i = 0; i < STRESS_CONSUMERS; i++)
+        lum_thread_join(consumers[i]);
+    double elapsed = get_wall_time() - start;
+
+    printf("%d producers / %d consumers: %d items in %.3fs (%.2f Mops/s)\n", STRESS_PRODUCERS,
+           STRESS_CONSUMERS, TOTAL, elapsed, TOTAL / elapsed / 1e6);
+
+    bool exactly_once = true;
+    for (int i = 0; i < TOTAL; i++)
+        exactly_once &= atomic_load(&seen[i]) == 1;
+    ASSERT_TRUE(exactly_once);
+    ASSERT_TRUE(atomic_load(&consumed) == TOTAL);
+    ASSERT_TRUE(lum_lfq_empty(queue));
+    ASSERT_TRUE(lum_lfq_dequeue(queue) == NULL);
+
+    free(seen);
+    lum_lfq_free(&queue);
+    return true;
+}
+
 // **Define test cases**
 TestCase cont_lfq_mt_tests[] = {
-    {"test_split_production_consumption", test_split_production_consumption}};
+    {"test_split_production_consumption", test_split_production_consumption},
+    {"test_mpmc_stress", test_mpmc_stress}};
 
 // **Test runner function**
 int cont_lfq_mt_tests_count = sizeof(cont_lfq_mt_tests) / sizeof(TestCase);
\ No newline at end of file
@@ -0,0 +1,244 @@
+#include "../test_framework.h"
+#include "containers/cont_hm.h"
+#include "containers/cont_shm.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SHM_KEYS 1000000
+
+typedef struct
+{
+    uint64_t id;
+    uint32_t generation;
+    uint32_t flags;
+} ShmValue;
+
+typedef struct
+{
+    uint32_t type;
+    uint32_t index;
+} ShmHandle;
+
+static uint64_t hash_handle(ShmHandle handle)
+{
+    return lum_hash_u64((uint64_t) handle.type << 32 | handle.index);
+}
+
+static bool handle_equal(ShmHandle a, ShmHandle b)
+{
+    return a.type == b.type && a.index == b.index;
+}
+
+LUM_HM_DECLARE(shm_int, int, int, lum_hash_u32, LUM_HM_EQ)
+LUM_HM_DECLARE(shm_handle, ShmHandle, ShmValue, hash_handle, handle_equal)
+
+// Inserts, overwrites, removes and growth against a plain array model
+static bool test_shm_basic_ops(void)
+{
+    lum_allocator *allocator = lum_create_default_allocator();
+    lum_shm_t      map;
+    ASSERT_TRUE(lum_shm_init(&map, sizeof(uint32_t), sizeof(ShmValue), 0, NULL, allocator));
+    ASSERT_TRUE(map.capacity == LUM_SHM_GROUP);
+
+    const uint32_t count = 5000;
+    for (uint32_t key = 0; key < count; key++)
+    {
+        ShmValue value = {key * 3ull, key, 0};
+        ASSERT_NOT_NULL(lum_shm_put(&map, &key, &value));
+    }
+    ASSERT_TRUE(map.count == count);
+    ASSERT_TRUE(lum_is_power_of_two(map.capacity));
+
+    // Overwrite the even keys, remove every third
+    for (uint32_t key = 0; key < count; key += 2)
+    {
+        ShmValue value = {key * 3ull, key, 1};
+        lum_shm_put(&map, &key, &value);
+    }
+    for (uint32_t key = 0; key < count; key += 3)
+        ASSERT_TRUE(lum_shm_remove(&map, &key));
+    uint32_t missing = count;
+    ASSERT_TRUE(!lum_shm_remove(&map, &missing));
+
+    for (uint32_t key = 0; key < count; key++)
+    {
+        ShmValue *value = lum_shm_get(&map, &key);
+        if (key % 3 == 0)
+        {
+            ASSERT_TRUE(value == NULL);
+            continue;
+        }
+        ASSERT_NOT_NULL(value);
+        ASSERT_TRUE(value->id == key * 3ull && value->generation == key);
+        ASSERT_TRUE(value->flags == (key % 2 == 0 ? 1u : 0u));
+    }
+
+    size_t it = 0, visited = 0;
+    void  *key, *value;
+    while (lum_shm_next(&map, &it, &key, &value))
+    {
+        ASSERT_TRUE(*(uint32_t *) key % 3 != 0);
+        ASSERT_TRUE(((ShmValue *) value)->generation == *(uint32_t *) key);
+        visited++;
+    }
+    ASSERT_TRUE(visited == map.count);
+
+    lum_shm_clear(&map);
+    ASSERT_TRUE(map.count == 0 && lum_shm_get(&map, &missing) == NULL);
+
+    lum_shm_destroy(&map);
+    lum_allocator_destroy(allocator);
+    return true;
+}
+
+// Insert/remove churn with a bounded live count: tombstones get cleaned up in place instead of
+// growing the table without end
+static bool test_shm_churn(void)
+{
+    lum_allocator *allocator = lum_create_default_allocator();
+    lum_shm_t      map;
+    ASSERT_TRUE(lum_shm_init(&map, sizeof(uint64_t), sizeof(uint64_t), 100, NULL, allocator));
+    size_t capacity = map.capacity;
+
+    for (uint64_t round = 0; round < 200; round++)
+    {
+        for (uint64_t i = 0; i < 100; i++)
+        {
+            uint64_t key = round * 100 + i;
+            ASSERT_NOT_NULL(lum_shm_put(&map, &key, &i));
+        }
+        for (uint64_t i = 0; i < 100; i++)
+        {
+            uint64_t  key   = round * 100 + i;
+            uint64_t *value = lum_shm_get(&map, &key);
+            ASSERT_TRUE(value && *value == i);
+            ASSERT_TRUE(lum_shm_remove(&map, &key));
+        }
+    }
+    ASSERT_TRUE(map.count == 0 && map.capacity <= 2 * capacity);
+
+    lum_shm_destroy(&map);
+    lum_allocator_destroy(allocator);
+    return true;
+}
+
+// Typed maps: struct keys with a custom equality, removal, growth and iteration
+static bool test_shm_typed(void)
+{
+    lum_allocator *allocator = lum_create_default_allocator();
+    shm_handle_t   map;
+    ASSERT_TRUE(shm_handle_init(&map, 0, allocator));
+
+    const uint32_t count = 5000;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ShmHandle handle = {i % 4, i};
+        ASSERT_NOT_NULL(shm_handle_put(&map, handle, (ShmValue){i * 3ull, i, 0}));
+    }
+    for (uint32_t i = 0; i < count; i += 2)
+        shm_handle_put(&map, (ShmHandle){i % 4, i}, (ShmValue){i * 3ull, i, 1});
+    for (uint32_t i = 0; i < count; i += 3)
+        ASSERT_TRUE(shm_handle_remove(&map, (ShmHandle){i % 4, i}));
+    ASSERT_TRUE(!shm_handle_remove(&map, (ShmHandle){1, 0}));
+    ASSERT_TRUE(map.count == count - (count + 2) / 3);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ShmValue *value = shm_handle_get(&map, (ShmHandle){i % 4, i});
+        ASSERT_TRUE((value == NULL) == (i % 3 == 0));
+        ASSERT_TRUE(!value || (value->id == i * 3ull && value->flags == (i % 2 == 0 ? 1u : 0u)));
+        ASSERT_TRUE(shm_handle_get(&map, (ShmHandle){(i + 1) % 4, i}) == NULL);
+    }
+
+    size_t             it = 0, visited = 0;
+    shm_handle_slot_t *slot;
+    while ((slot = shm_handle_next(&map, &it)) != NULL)
+    {
+        ASSERT_TRUE(slot->key.index % 3 != 0 && slot->value.generation == slot->key.index);
+        visited++;
+    }
+    ASSERT_TRUE(visited == map.count);
+
+    shm_handle_clear(&map);
+    ASSERT_TRUE(map.count == 0 && shm_handle_get(&map, (ShmHandle){1, 1}) == NULL);
+    shm_handle_destroy(&map);
+    lum_allocator_destroy(allocator);
+    return true;
+}
+
+// Same workload as the lum_hm benchmark: typed map, generic lum_shm and lum_hm
+static bool test_shm_benchmark(void)
+{
+    lum_allocator *allocator = lum_create_default_allocator();
+    lum_shm_t      map;
+    ASSERT_TRUE(lum_shm_init(&map, sizeof(int), sizeof(int), 0, lum_hash_xxhash, allocator));
+
+    uint64_t start = lum_time_now_ns();
+    for (int i = 0; i < SHM_KEYS; i++)
+    {
+        int value = i * 2;
+        lum_shm_put(&map, &i, &value);
+    }
+    for (int i = 0; i < SHM_KEYS; i++)
+    {
+        int *value = lum_shm_get(&map, &i);
+        ASSERT_TRUE(value && *value == i * 2);
+    }
+    for (int i = SHM_KEYS; i < 2 * SHM_KEYS; i++)
+        ASSERT_TRUE(lum_shm_get(&map, &i) == NULL);
+    for (int i = 0; i < SHM_KEYS; i++)
+        lum_shm_remove(&map, &i);
+    double shm_ms = (double) (lum_time_now_ns() - start) / 1e6;
+    ASSERT_TRUE(map.count == 0);
+    lum_shm_destroy(&map);
+
+    shm_int_t typed;
+    ASSERT_TRUE(shm_int_init(&typed, 0, allocator));
+    start = lum_time_now_ns();
+    for (int i = 0; i < SHM_KEYS; i++)
+        shm_int_put(&typed, i, i * 2);
+    for (int i = 0; i < SHM_KEYS; i++)
+    {
+        int *value = shm_int_get(&typed, i);
+        ASSERT_TRUE(value && *value == i * 2);
+    }
+    for (int i = SHM_KEYS; i < 2 * SHM_KEYS; i++)
+        ASSERT_TRUE(shm_int_get(&typed, i) == NULL);
+    for (int i = 0; i < SHM_KEYS; i++)
+        shm_int_remove(&typed, i);
+    double typed_ms = (double) (lum_time_now_ns() - start) / 1e6;
+    ASSERT_TRUE(typed.count == 0);
+    shm_int_destroy(&typed);
+
+    lum_hm *hm = lum_hm_create(4 * SHM_KEYS, lum_hash_xxhash, allocator);
+    ASSERT_NOT_NULL(hm);
+    start = lum_time_now_ns();
+    for (int i = 0; i < SHM_KEYS; i++)
+    {
+        int value = i * 2;
+        lum_hm_put(hm, i, value);
+    }
+    for (int i = 0; i < 2 * SHM_KEYS; i++)
+    {
+        int value;
+        lum_hm_get(hm, i, value);
+    }
+    for (int i = 0; i < SHM_KEYS; i++)
+        lum_hm_remove(hm, i);
+    double hm_ms = (double) (lum_time_now_ns() - start) / 1e6;
+    lum_hm_free(hm); // Destroys the allocator too
+
+    printf("    %d keys: typed %.1f ms, lum_shm %.1f ms, lum_hm %.1f ms\n", SHM_KEYS, typed_ms,
+           shm_ms, hm_ms);
+    return true;
+}
+
+// **Define test cases**
+TestCase cont_shm_tests[] = {{"test_shm_basic_ops", test_shm_basic_ops},
+                             {"test_shm_churn", test_shm_churn},
+                             {"test_shm_typed", test_shm_typed},
+                             {"test_shm_benchmark", test_shm_benchmark}};
+
+// **Test runner function**
+int cont_shm_tests_count = sizeof(cont_shm_tests) / sizeof(TestCase);
@@ -10,11 +10,15 @@ extern TestCase frame_alloc_tests[];
 extern TestCase stack_alloc_tests[];
 extern TestCase cont_da_tests[];
 extern TestCase cont_hm_tests[];
+extern TestCase cont_shm_tests[];
 extern TestCase pool_alloc_tests[];
 // extern TestCase job_scheduling_tests[];
 extern TestCase cont_lfq_tests[];
 extern TestCase cont_lfq_mt_tests[];
 extern TestCase lum_scheduler_tests[];
+extern TestCase lum_parallel_tests[];
+extern TestCase lum_task_graph_tests[];
+extern TestCase lum_timer_wheel_tests[];
 
 // **Manually specify the size**
 extern int vec_tests_count;
@@ -26,11 +30,15 @@ extern int frame_alloc_tests_count;
 extern int stack_alloc_tests_count;
 extern int cont_da_tests_count;
 extern int cont_hm_tests_count;
+extern int cont_shm_tests_count;
 extern int pool_alloc_tests_count;
 // extern int job_scheduling_tests_count;
 extern int cont_lfq_tests_count;
 extern int cont_lfq_mt_tests_count;
 extern int lum_scheduler_tests_count;
+extern int lum_parallel_tests_count;
+extern int lum_task_graph_tests_count;
+extern int lum_timer_wheel_tests_count;
 
 int main()
 {
@@ -46,9 +54,13 @@ int main()
     RUN_TESTS("Pool Allocator Tests", pool_alloc_tests, pool_alloc_tests_count);
     RUN_TESTS("ContDA Tests", cont_da_tests, cont_da_tests_count);
     RUN_TESTS("ContHM Tests", cont_hm_tests, cont_hm_tests_count);
+    RUN_TESTS("ContSHM Tests", cont_shm_tests, cont_shm_tests_count);
     RUN_TESTS("ContLFQ Tests", cont_lfq_tests, cont_lfq_tests_count);
     RUN_TESTS("ContLFQ_MT Tests", cont_lfq_mt_tests, cont_lfq_mt_tests_count);
     RUN_TESTS("Scheduling Tests", lum_scheduler_tests, lum_scheduler_tests_count);
+    RUN_TESTS("Parallel Tests", lum_parallel_tests, lum_parallel_tests_count);
+    RUN_TESTS("Task Graph Tests", lum_task_graph_tests, lum_task_graph_tests_count);
+    RUN_TESTS("Timer Wheel Tests", lum_timer_wheel_tests, lum_timer_wheel_tests_count);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,237 @@
+// Scheduler benchmarks: empty-job throughput, fan-out/fan-in latency, dependency-chain latency
+// and contention scaling, for each scheduler mode.
+//
+// Usage: LumenSchedulerBench [max_threads] [rounds]
+//   max_threads: largest worker count (default: every CPU), scaling runs 1, 2, 4, ... up to it
+//   rounds:      samples per latency benchmark (default 200)
+
+#include "../memory/allocators/mem_alloc.h"
+#include "lum_scheduler.h"
+#include "lum_thread.h"
+#include "platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_THROUGHPUT_JOBS 100000
+#define BENCH_FANOUT 256
+#define BENCH_CHAIN 64
+#define BENCH_SPAWN_ROOTS 64
+#define BENCH_SPAWN_CHILDREN 256
+#define BENCH_SPAWN_ROUNDS 20
+
+typedef struct
+{
+    const char          *name;
+    lum_balance_policy_t type;
+    lum_queue_type_t     queue_type;
+} bench_mode_t;
+
+static const bench_mode_t bench_modes[] = {
+    {"fifo", LUM_SCHEDULER_ROUND_ROBIN, LUM_QUEUE_FIFO},
+    {"work-stealing", LUM_SCHEDULER_WORK_STEALING, LUM_QUEUE_FIFO},
+    {"priority", LUM_SCHEDULER_ROUND_ROBIN, LUM_QUEUE_PRIORITY},
+};
+
+static lum_scheduler_t *bench_scheduler = NULL; // For jobs that spawn jobs
+
+static void *bench_empty(void *arg)
+{
+    (void) arg;
+    return NULL;
+}
+
+// Records when the job started into the uint64_t at arg
+static void *bench_stamp(void *arg)
+{
+    *(uint64_t *) arg = lum_time_now_ns();
+    return NULL;
+}
+
+static void *bench_spawn(void *arg)
+{
+    (void) arg;
+    for (int i = 0; i < BENCH_SPAWN_CHILDREN; i++)
+        lum_scheduler_submit(bench_scheduler,
+                             lum_scheduler_create_job(bench_scheduler, bench_empty, NULL));
+    return NULL;
+}
+
+static int bench_compare(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a;
+    uint64_t y = *(const uint64_t *) b;
+    return (x > y) - (x < y);
+}
+
+// Sorts the samples
+static void bench_report(const char *name, uint64_t *samples, size_t count, double jobs_per_sec)
+{
+    qsort(samples, count, sizeof(uint64_t), bench_compare);
+    double p50  = (double) samples[(count - 1) * 50 / 100] / 1000.0;
+    double p99  = (double) samples[(count - 1) * 99 / 100] / 1000.0;
+    double p999 = (double) samples[(count - 1) * 999 / 1000] / 1000.0;
+    printf("  %-22s p50 %10.2f us  p99 %10.2f us  p999 %10.2f us  %12.0f jobs/s\n", name, p50,
+           p99, p999, jobs_per_sec);
+}
+
+static lum_scheduler_t *bench_create(lum_scheduler_config_t *config, const bench_mode_t *mode,
+                                     size_t threads)
+{
+    *config                = (lum_scheduler_config_t){0};
+    config->type           = mode->type;
+    config->queue_type     = mode->queue_type;
+    config->num_threads    = threads;
+    config->queue_capacity = 8192;
+    return lum_scheduler_create(config);
+}
+
+// Empty jobs submitted one by one: submit-to-start latency per job, overall jobs/sec
+static void bench_throughput(lum_scheduler_t *s, uint64_t *submitted, uint64_t *started)
+{
+    uint64_t begin = lum_time_now_ns();
+    for (size_t i = 0; i < BENCH_THROUGHPUT_JOBS; i++)
+    {
+        Job *job     = lum_scheduler_create_job(s, bench_stamp, &started[i]);
+        submitted[i] = lum_time_now_ns();
+        lum_scheduler_submit(s, job);
+    }
+    lum_scheduler_wait_completion(s);
+    uint64_t elapsed = lum_time_now_ns() - begin;
+
+    for (size_t i = 0; i < BENCH_THROUGHPUT_JOBS; i++)
+        submitted[i] = started[i] > submitted[i] ? started[i] - submitted[i] : 0;
+    bench_report("empty jobs", submitted, BENCH_THROUGHPUT_JOBS,
+                 BENCH_THROUGHPUT_JOBS * 1e9 / (double) elapsed);
+}
+
+// BENCH_FANOUT jobs submitted as one batch and waited on with a counter
+static void bench_fanout(lum_scheduler_t *s, uint64_t *samples, size_t rounds)
+{
+    Job          *jobs[BENCH_FANOUT];
+    lum_counter_t counter;
+    lum_counter_init(&counter);
+
+    uint64_t total = 0;
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < BENCH_FANOUT; i++)
+            jobs[i] = lum_scheduler_create_job(s, bench_empty, NULL);
+        uint64_t begin = lum_time_now_ns();
+        lum_scheduler_submit_batch_counted(s, jobs, BENCH_FANOUT, &counter);
+        lum_scheduler_wait_counter(s, &counter);
+        samples[r] = lum_time_now_ns() - begin;
+        total += samples[r];
+    }
+    bench_report("fan-out/fan-in", samples, rounds,
+                 (double) (rounds * BENCH_FANOUT) * 1e9 / (double) total);
+}
+
+// BENCH_CHAIN jobs that each depend on the previous one
+static void bench_chain(lum_scheduler_t *s, uint64_t *samples, size_t rounds)
+{
+    Job *jobs[BENCH_CHAIN];
+
+    uint64_t total = 0;
+    for (size_t r = 0; r < rounds; r++)
+    {
+        for (size_t i = 0; i < BENCH_CHAIN; i++)
+        {
+            jobs[i] = lum_scheduler_create_job(s, bench_empty, NULL);
+            if (i > 0)
+                lum_job_add_dependency(jobs[i - 1], jobs[i]);
+        }
+        uint64_t begin = lum_time_now_ns();
+        lum_scheduler_submit_batch(s, jobs, BENCH_CHAIN);
+        lum_scheduler_wait_completion(s);
+        samples[r] = lum_time_now_ns() - begin;
+        total += samples[r];
+    }
+    bench_report("dependency chain", samples, rounds,
+                 (double) (rounds * BENCH_CHAIN) * 1e9 / (double) total);
+}
+
+// Jobs spawning jobs from the workers: how submission and stealing scale with the worker count
+static void bench_scaling(const bench_mode_t *mode, size_t max_threads)
+{
+    uint64_t samples[BENCH_SPAWN_ROUNDS];
+    // 1, 2, 4, ... and always max_threads last
+    for (size_t threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads)
+    {
+        lum_scheduler_config_t config;
+        bench_scheduler = bench_create(&config, mode, threads);
+        if (!bench_scheduler)
+            return;
+
+        uint64_t total = 0;
+        for (size_t r = 0; r < BENCH_SPAWN_ROUNDS; r++)
+        {
+            uint64_t begin = lum_time_now_ns();
+            for (int i = 0; i < BENCH_SPAWN_ROOTS; i++)
+                lum_scheduler_submit(bench_scheduler,
+                                     lum_scheduler_create_job(bench_scheduler, bench_spawn, NULL));
+            lum_scheduler_wait_completion(bench_scheduler);
+            samples[r] = lum_time_now_ns() - begin;
+            total += samples[r];
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "spawn, %zu thread%s", threads, threads == 1 ? "" : "s");
+        double jobs = (double) BENCH_SPAWN_ROUNDS * BENCH_SPAWN_ROOTS * (BENCH_SPAWN_CHILDREN + 1);
+        bench_report(name, samples, BENCH_SPAWN_ROUNDS, jobs * 1e9 / (double) total);
+
+        lum_scheduler_destroy(bench_scheduler);
+        lum_allocator_destroy(config.allocator);
+        bench_scheduler = NULL;
+        if (threads >= max_threads)
+            break;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    lum_topology_t topology;
+    lum_topology_query(&topology);
+    size_t max_threads = argc > 1 ? (size_t) strtoul(argv[1], NULL, 10) : 0;
+    size_t rounds      = argc > 2 ? (size_t) strtoul(argv[2], NULL, 10) : 200;
+    if (max_threads == 0)
+        max_threads = topology.cpu_count > 0 ? (size_t) topology.cpu_count : 4;
+    if (rounds == 0)
+        rounds = 1;
+
+    uint64_t *submitted = malloc(BENCH_THROUGHPUT_JOBS * sizeof(uint64_t));
+    uint64_t *started   = malloc(BENCH_THROUGHPUT_JOBS * sizeof(uint64_t));
+    uint64_t *samples   = malloc(rounds * sizeof(uint64_t));
+    if (!submitted || !started || !samples)
+        return 1;
+
+    printf("Lumen scheduler benchmarks: %zu worker threads, %zu rounds, %d CPUs\n", max_threads,
+           rounds, topology.cpu_count);
+    for (size_t m = 0; m < sizeof(bench_modes) / sizeof(bench_modes[0]); m++)
+    {
+        const bench_mode_t *mode = &bench_modes[m];
+        printf("\n[%s]\n", mode->name);
+
+        lum_scheduler_config_t config;
+        lum_scheduler_t       *scheduler = bench_create(&config, mode, max_threads);
+        if (!scheduler)
+        {
+            printf("  failed to create the scheduler\n");
+            continue;
+        }
+        memset(started, 0, BENCH_THROUGHPUT_JOBS * sizeof(uint64_t));
+        bench_throughput(scheduler, submitted, started);
+        bench_fanout(scheduler, samples, rounds);
+        bench_chain(scheduler, samples, rounds);
+        lum_scheduler_destroy(scheduler);
+        lum_allocator_destroy(config.allocator);
+
+        bench_scaling(mode, max_threads);
+    }
+
+    free(submitted);
+    free(started);
+    free(samples);
+    return 0;
+}
@@ -0,0 +1,341 @@
+#include "../test_framework.h"
+#include "lum_parallel.h"
+#include "lum_scheduler.h"
+#include "platform.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PARALLEL_COUNT 100000
+#define SORT_BENCH_COUNT 1000000
+
+static lum_scheduler_t *create_fiber_scheduler(lum_balance_policy_t type, bool fibers)
+{
+    static lum_scheduler_config_t config;
+    config                = (lum_scheduler_config_t){0};
+    config.type           = type;
+    config.num_threads    = 4;
+    config.queue_capacity = 256;
+    config.use_fibers     = fibers;
+    return lum_scheduler_create(&config);
+}
+
+static lum_scheduler_t *create_scheduler(lum_balance_policy_t type)
+{
+    return create_fiber_scheduler(type, false);
+}
+
+static void square_body(size_t begin, size_t end, void *ctx)
+{
+    uint64_t *values = (uint64_t *) ctx;
+    for (size_t i = begin; i < end; i++)
+        values[i] = (uint64_t) i * i;
+}
+
+static bool test_parallel_for(void)
+{
+    uint64_t *values = calloc(PARALLEL_COUNT, sizeof(uint64_t));
+    ASSERT_NOT_NULL(values);
+
+    lum_scheduler_t *scheduler = create_scheduler(LUM_SCHEDULER_ROUND_ROBIN);
+    ASSERT_NOT_NULL(scheduler);
+
+    // Automatic grain, explicit grain, and a range that is not a multiple of the grain
+    size_t grains[] = {0, 1000, 333};
+    for (size_t g = 0; g < sizeof(grains) / sizeof(grains[0]); g++)
+    {
+        memset(values, 0, PARALLEL_COUNT * sizeof(uint64_t));
+        lum_parallel_for(scheduler, 10, PARALLEL_COUNT, grains[g], square_body, values);
+        ASSERT_TRUE(values[9] == 0);
+        for (size_t i = 10; i < PARALLEL_COUNT; i++)
+            ASSERT_TRUE(values[i] == (uint64_t) i * i);
+    }
+
+    lum_scheduler_destroy(scheduler);
+    free(values);
+    return true;
+}
+
+static lum_scheduler_t *nested_scheduler = NULL;
+static atomic_int       nested_total     = 0;
+
+static void inner_body(size_t begin, size_t end, void *ctx)
+{
+    (void) ctx;
+    atomic_fetch_add(&nested_total, (int) (end - begin));
+}
+
+// Runs on workers: the inner loop is split from inside a job and waited on there
+static void outer_body(size_t begin, size_t end, void *ctx)
+{
+    (void) ctx;
+    for (size_t i = begin; i < end; i++)
+        lum_parallel_for(nested_scheduler, 0, 1000, 50, inner_body, NULL);
+}
+
+// Inner loops join from inside jobs: by helping, or in fiber mode by suspending the job
+static bool test_parallel_for_nested(void)
+{
+    for (int fibers = 0; fibers < 2; fibers++)
+    {
+        nested_scheduler = create_fiber_scheduler(LUM_SCHEDULER_WORK_STEALING, fibers);
+        ASSERT_NOT_NULL(nested_scheduler);
+        atomic_store(&nested_total, 0);
+
+        lum_parallel_for(nested_scheduler, 0, 16, 1, outer_body, NULL);
+        ASSERT_TRUE(atomic_load(&nested_total) == 16 * 1000);
+
+        lum_scheduler_destroy(nested_scheduler);
+        nested_scheduler = NULL;
+    }
+    return true;
+}
+
+static void sum_body(size_t begin, size_t end, void *partial, void *ctx)
+{
+    (void) ctx;
+    uint64_t *sum = (uint64_t *) partial;
+    for (size_t i = begin; i < end; i++)
+        *sum += i;
+}
+
+static void sum_combine(void *accum, const void *value, void *ctx)
+{
+    (void) ctx;
+    *(uint64_t *) accum += *(const uint64_t *) value;
+}
+
+// Affine maps x -> a * x + b composed left to right: associative but not commutative
+typedef struct
+{
+    uint64_t a, b;
+} Affine;
+
+static void affine_combine(void *accum, const void *value, void *ctx)
+{
+    (void) ctx;
+    Affine       *f = (Affine *) accum;
+    const Affine *g = (const Affine *) value;
+    f->b            = g->a * f->b + g->b;
+    f->a            = g->a * f->a;
+}
+
+static void affine_body(size_t begin, size_t end, void *partial, void *ctx)
+{
+    (void) ctx;
+    for (size_t i = begin; i < end; i++)
+    {
+        Affine step = {2 * i + 1, i};
+        affine_combine(partial, &step, NULL);
+    }
+}
+
+static bool test_parallel_reduce(void)
+{
+    lum_scheduler_t *scheduler = create_scheduler(LUM_SCHEDULER_WORK_STEALING);
+    ASSERT_NOT_NULL(scheduler);
+
+    uint64_t zero = 0, sum = 0;
+    ASSERT_TRUE(lum_parallel_reduce(scheduler, 0, PARALLEL_COUNT, 0, &sum, &zero, sizeof(sum),
+                                    sum_body, sum_combine, NULL));
+    ASSERT_TRUE(sum == (uint64_t) PARALLEL_COUNT * (PARALLEL_COUNT - 1) / 2);
+
+    // Partials must be combined in order
+    Affine identity = {1, 0}, parallel, serial = {1, 0};
+    ASSERT_TRUE(lum_parallel_reduce(scheduler, 0, PARALLEL_COUNT, 97, &parallel, &identity,
+                                    sizeof(Affine), affine_body, affine_combine, NULL));
+    affine_body(0, PARALLEL_COUNT, &serial, NULL);
+    ASSERT_TRUE(parallel.a == serial.a && parallel.b == serial.b);
+
+    // Empty range yields the identity
+    sum = 42;
+    ASSERT_TRUE(lum_parallel_reduce(scheduler, 5, 5, 0, &sum, &zero, sizeof(sum), sum_body,
+                                    sum_combine, NULL));
+    ASSERT_TRUE(sum == 0);
+
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+static bool test_parallel_scan(void)
+{
+    lum_scheduler_t *scheduler = create_scheduler(LUM_SCHEDULER_WORK_STEALING);
+    ASSERT_NOT_NULL(scheduler);
+
+    uint64_t *input  = malloc(PARALLEL_COUNT * sizeof(uint64_t));
+    uint64_t *output = malloc(PARALLEL_COUNT * sizeof(uint64_t));
+    ASSERT_TRUE(input && output);
+    for (size_t i = 0; i < PARALLEL_COUNT; i++)
+        input[i] = i % 7;
+
+    ASSERT_TRUE(lum_parallel_scan(scheduler, input, output, PARALLEL_COUNT, sizeof(uint64_t), 0,
+                                  sum_combine, NULL));
+    uint64_t running = 0;
+    for (size_t i = 0; i < PARALLEL_COUNT; i++)
+    {
+        running += input[i];
+        ASSERT_TRUE(output[i] == running);
+    }
+
+    // In place, non-commutative
+    Affine *maps = malloc(PARALLEL_COUNT * sizeof(Affine));
+    ASSERT_NOT_NULL(maps);
+    for (size_t i = 0; i < PARALLEL_COUNT; i++)
+        maps[i] = (Affine){2 * i + 1, i};
+    ASSERT_TRUE(lum_parallel_scan(scheduler, maps, maps, PARALLEL_COUNT, sizeof(Affine), 123,
+                                  affine_combine, NULL));
+    Affine expected = {1, 0};
+    for (size_t i = 0; i < PARALLEL_COUNT; i++)
+    {
+        Affine step = {2 * i + 1, i};
+        affine_combine(&expected, &step, NULL);
+        ASSERT_TRUE(maps[i].a == expected.a && maps[i].b == expected.b);
+    }
+
+    free(maps);
+    free(input);
+    free(output);
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+static uint64_t sort_random(uint64_t *state)
+{
+    *state = *state * 6364136223846793005ull + 1442695040888963407ull;
+    return *state ^ (*state >> 29);
+}
+
+static bool test_parallel_radix_sort(void)
+{
+    lum_scheduler_t *scheduler = create_scheduler(LUM_SCHEDULER_WORK_STEALING);
+    ASSERT_NOT_NULL(scheduler);
+
+    // Few distinct keys: the payload (original index) must stay ascending within a key
+    lum_sort_pair32_t *pairs = malloc(PARALLEL_COUNT * sizeof(lum_sort_pair32_t));
+    ASSERT_NOT_NULL(pairs);
+    uint64_t state = 1;
+    for (size_t i = 0; i < PARALLEL_COUNT; i++)
+        pairs[i] = (lum_sort_pair32_t){(uint32_t) (sort_random(&state) % 1000) << 12,
+                                       (uint32_t) i};
+    ASSERT_TRUE(lum_parallel_radix_sort32(scheduler, pairs, NULL, PARALLEL_COUNT));
+    for (size_t i = 1; i < PARALLEL_COUNT; i++)
+    {
+        ASSERT_TRUE(pairs[i - 1].key <= pairs[i].key);
+        ASSERT_TRUE(pairs[i - 1].key < pairs[i].key || pairs[i - 1].value < pairs[i].value);
+    }
+    ASSERT_TRUE(lum_parallel_radix_sort32(scheduler, pairs, NULL, 1));
+
+    // Keys below 256 take a single scatter pass, keys below 2^24 three: the result ends up in the
+    // scratch buffer and has to be copied back, with the sort's own buffer and the caller's
+    lum_sort_pair32_t *scratch32 = malloc(PARALLEL_COUNT * sizeof(lum_sort_pair32_t));
+    ASSERT_NOT_NULL(scratch32);
+    uint32_t key_limits[] = {256, 1u << 24};
+    for (int pass = 0; pass < 4; pass++)
+    {
+        uint32_t limit   = key_limits[pass % 2];
+        uint64_t key_sum = 0;
+        for (size_t i = 0; i < PARALLEL_COUNT; i++)
+        {
+            pairs[i] = (lum_sort_pair32_t){(uint32_t) (sort_random(&state) % limit), (uint32_t) i};
+            key_sum += pairs[i].key;
+        }
+        ASSERT_TRUE(lum_parallel_radix_sort32(scheduler, pairs, pass < 2 ? NULL : scratch32,
+                                              PARALLEL_COUNT));
+        for (size_t i = 0; i < PARALLEL_COUNT; i++)
+        {
+            key_sum -= pairs[i].key;
+            if (i == 0)
+                continue;
+            ASSERT_TRUE(pairs[i - 1].key <= pairs[i].key);
+            ASSERT_TRUE(pairs[i - 1].key < pairs[i].key || pairs[i - 1].value < pairs[i].value);
+        }
+        ASSERT_TRUE(key_sum == 0);
+    }
+    free(scratch32);
+    free(pairs);
+
+    // Full range 64-bit keys with a caller-provided scratch buffer
+    lum_sort_pair64_t *wide    = malloc(SORT_BENCH_COUNT * sizeof(lum_sort_pair64_t));
+    lum_sort_pair64_t *scratch = malloc(SORT_BENCH_COUNT * sizeof(lum_sort_pair64_t));
+    ASSERT_TRUE(wide && scratch);
+    uint64_t key_sum = 0;
+    for (size_t i = 0; i < SORT_BENCH_COUNT; i++)
+    {
+        wide[i] = (lum_sort_pair64_t){sort_random(&state), i};
+        key_sum += wide[i].key;
+    }
+    uint64_t start = lum_time_now_ns();
+    ASSERT_TRUE(lum_parallel_radix_sort64(scheduler, wide, scratch, SORT_BENCH_COUNT));
+    printf("    radix sort of %d 64-bit keys: %.2f ms\n", SORT_BENCH_COUNT,
+           (double) (lum_time_now_ns() - start) / 1e6);
+    for (size_t i = 0; i < SORT_BENCH_COUNT; i++)
+    {
+        ASSERT_TRUE(i == 0 || wide[i - 1].key <= wide[i].key);
+        key_sum -= wide[i].key;
+    }
+    ASSERT_TRUE(key_sum == 0);
+
+    free(wide);
+    free(scratch);
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+typedef struct
+{
+    int      key;
+    uint32_t index;
+} SortRecord;
+
+static int compare_records(const void *a, const void *b, void *ctx)
+{
+    (void) ctx;
+    int x = ((const SortRecord *) a)->key;
+    int y = ((const SortRecord *) b)->key;
+    return (x > y) - (x < y);
+}
+
+static bool test_parallel_merge_sort(void)
+{
+    lum_scheduler_t *scheduler = create_scheduler(LUM_SCHEDULER_WORK_STEALING);
+    ASSERT_NOT_NULL(scheduler);
+
+    SortRecord *records = malloc(PARALLEL_COUNT * sizeof(SortRecord));
+    ASSERT_NOT_NULL(records);
+
+    // Empty, single, short and uneven lengths, with many equal keys to check stability
+    size_t   counts[] = {0, 1, 31, 4097, PARALLEL_COUNT - 3};
+    uint64_t state    = 7;
+    for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++)
+    {
+        size_t count = counts[c];
+        for (size_t i = 0; i < count; i++)
+            records[i] = (SortRecord){(int) (sort_random(&state) % 512) - 256, (uint32_t) i};
+        ASSERT_TRUE(lum_parallel_merge_sort(scheduler, records, count, sizeof(SortRecord),
+                                            compare_records, NULL));
+        for (size_t i = 1; i < count; i++)
+        {
+            ASSERT_TRUE(records[i - 1].key <= records[i].key);
+            ASSERT_TRUE(records[i - 1].key < records[i].key ||
+                        records[i - 1].index < records[i].index);
+        }
+    }
+
+    free(records);
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+// **Define test cases**
+TestCase lum_parallel_tests[] = {
+    {"test_parallel_for", test_parallel_for},
+    {"test_parallel_for_nested", test_parallel_for_nested},
+    {"test_parallel_reduce", test_parallel_reduce},
+    {"test_parallel_scan", test_parallel_scan},
+    {"test_parallel_radix_sort", test_parallel_radix_sort},
+    {"test_parallel_merge_sort", test_parallel_merge_sort}};
+
+// **Test runner function**
+int lum_parallel_tests_count = sizeof(lum_parallel_tests) / sizeof(TestCase);
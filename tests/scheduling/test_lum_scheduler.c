@@ -1,6 +1,7 @@
 #include "../memory/allocators/mem_alloc.h"
 #include "../math/math_rand.h"
 #include "../test_framework.h"
+#include "lum_job_pool.h"
 #include "lum_scheduler.h"
 #include "lum_thread.h"
 #include "platform.h"
@@ -9,6 +10,7 @@
 #include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #define TEST_NUM_JOBS 64
@@ -188,11 +190,1041 @@ static bool test_scheduler_stress(void)
     return true;
 }
 
+#define SPAWN_ROOTS 16
+#define SPAWN_CHILDREN 64
+
+static lum_scheduler_t *spawn_scheduler = NULL;
+
+// Root job that fans out children from inside a worker (they land on its local deque)
+static void *spawning_job(void *arg)
+{
+    (void) arg;
+    for (int i = 0; i < SPAWN_CHILDREN; i++)
+    {
+        Job *child = lum_scheduler_create_job(spawn_scheduler, fast_job, NULL);
+        lum_scheduler_submit(spawn_scheduler, child);
+    }
+    atomic_fetch_add(&fast_counter, 1);
+    return NULL;
+}
+
+static bool test_scheduler_work_stealing(void)
+{
+    atomic_store(&fast_counter, 0);
+
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads            = 4;
+    config.queue_capacity         = 1024;
+
+    spawn_scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(spawn_scheduler);
+    ASSERT_TRUE(spawn_scheduler->stealing);
+
+    for (int i = 0; i < SPAWN_ROOTS; i++)
+    {
+        Job *job = lum_scheduler_create_job(spawn_scheduler, spawning_job, NULL);
+        lum_scheduler_submit(spawn_scheduler, job);
+    }
+
+    lum_scheduler_wait_completion(spawn_scheduler);
+    lum_scheduler_destroy(spawn_scheduler);
+    spawn_scheduler = NULL;
+
+    ASSERT_TRUE(atomic_load(&fast_counter) == SPAWN_ROOTS * (SPAWN_CHILDREN + 1));
+    return true;
+}
+
+typedef struct
+{
+    atomic_int *clock;
+    int         stamp; // Order in which this job ran
+} OrderArg;
+
+static void *ordered_job(void *arg)
+{
+    OrderArg *oa = (OrderArg *) arg;
+    oa->stamp    = atomic_fetch_add(oa->clock, 1);
+    return NULL;
+}
+
+// Diamond A -> {B, C} -> D followed by a chain D -> E0 -> ... -> En
+static bool test_scheduler_dependencies(void)
+{
+    enum { CHAIN = 32, NODES = 4 + CHAIN };
+
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads            = 4;
+    config.queue_capacity         = 256;
+
+    lum_scheduler_t *scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+
+    atomic_int clock = 0;
+    OrderArg   args[NODES];
+    Job       *jobs[NODES];
+    for (int i = 0; i < NODES; i++)
+    {
+        args[i].clock = &clock;
+        args[i].stamp = -1;
+        jobs[i]       = lum_scheduler_create_job(scheduler, ordered_job, &args[i]);
+    }
+
+    ASSERT_TRUE(lum_job_add_dependency(jobs[0], jobs[1]));
+    ASSERT_TRUE(lum_job_add_dependency(jobs[0], jobs[2]));
+    ASSERT_TRUE(lum_job_add_dependency(jobs[1], jobs[3]));
+    ASSERT_TRUE(lum_job_add_dependency(jobs[2], jobs[3]));
+    for (int i = 4; i < NODES; i++)
+        ASSERT_TRUE(lum_job_add_dependency(jobs[i - 1], jobs[i]));
+
+    // Submit leaves first so held jobs are exercised
+    for (int i = NODES - 1; i >= 0; i--)
+        lum_scheduler_submit(scheduler, jobs[i]);
+
+    lum_scheduler_wait_completion(scheduler);
+    lum_scheduler_destroy(scheduler);
+
+    ASSERT_TRUE(atomic_load(&clock) == NODES);
+    ASSERT_TRUE(args[0].stamp < args[1].stamp && args[0].stamp < args[2].stamp);
+    ASSERT_TRUE(args[1].stamp < args[3].stamp && args[2].stamp < args[3].stamp);
+    for (int i = 4; i < NODES; i++)
+        ASSERT_TRUE(args[i - 1].stamp < args[i].stamp);
+    return true;
+}
+
+static bool test_scheduler_wait_policies(void)
+{
+    const lum_wait_policy_t policies[] = {LUM_WAIT_COND_VAR, LUM_WAIT_BACKOFF, LUM_WAIT_SPINLOCK,
+                                          LUM_WAIT_HYBRID};
+
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++)
+    {
+        atomic_store(&fast_counter, 0);
+
+        lum_scheduler_config_t config = {0};
+        config.type                   = LUM_SCHEDULER_WORK_STEALING;
+        config.wait_policy            = policies[p];
+        config.num_threads            = 4;
+        config.queue_capacity         = 1024;
+
+        spawn_scheduler = lum_scheduler_create(&config);
+        ASSERT_NOT_NULL(spawn_scheduler);
+
+        // Two rounds so workers go idle in between
+        for (int round = 0; round < 2; round++)
+        {
+            for (int i = 0; i < SPAWN_ROOTS; i++)
+            {
+                Job *job = lum_scheduler_create_job(spawn_scheduler, spawning_job, NULL);
+                lum_scheduler_submit(spawn_scheduler, job);
+            }
+            lum_scheduler_wait_completion(spawn_scheduler);
+            lum_thread_sleep(5);
+        }
+
+        lum_scheduler_destroy(spawn_scheduler);
+        spawn_scheduler = NULL;
+        ASSERT_TRUE(atomic_load(&fast_counter) == 2 * SPAWN_ROOTS * (SPAWN_CHILDREN + 1));
+    }
+    return true;
+}
+
+// Short bursts with idle gaps so workers repeatedly park and are woken again
+static bool test_scheduler_park_wake(void)
+{
+    enum { ROUNDS = 200, BURST = 4 };
+
+    atomic_store(&fast_counter, 0);
+
+    lum_scheduler_config_t config = {0};
+    config.num_threads            = 4;
+    config.queue_capacity         = ROUNDS * BURST;
+
+    lum_scheduler_t *scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        for (int i = 0; i < BURST; i++)
+            lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, fast_job, NULL));
+        lum_scheduler_wait_completion(scheduler);
+        ASSERT_TRUE(atomic_load(&fast_counter) == (round + 1) * BURST);
+    }
+
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+static pthread_t  waiting_thread;
+static atomic_int helped_jobs   = 0;
+static atomic_int pending_batch = 0;
+
+static void *slow_job(void *arg)
+{
+    (void) arg;
+    lum_thread_sleep(1);
+    if (pthread_equal(pthread_self(), waiting_thread))
+        atomic_fetch_add(&helped_jobs, 1);
+    atomic_fetch_add(&fast_counter, 1);
+    atomic_fetch_sub(&pending_batch, 1);
+    return NULL;
+}
+
+static bool test_scheduler_help_while_waiting(void)
+{
+    enum { JOBS = 32 };
+
+    lum_scheduler_config_t config = {0};
+    config.num_threads            = 1;
+    config.queue_capacity         = 2 * JOBS;
+    config.help_while_waiting     = true;
+
+    lum_scheduler_t *scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+    waiting_thread = pthread_self();
+    atomic_store(&fast_counter, 0);
+    atomic_store(&helped_jobs, 0);
+
+    // Global wait
+    for (int i = 0; i < JOBS; i++)
+        lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, slow_job, NULL));
+    lum_scheduler_wait_completion(scheduler);
+    ASSERT_TRUE(atomic_load(&fast_counter) == JOBS);
+    ASSERT_TRUE(atomic_load(&helped_jobs) > 0);
+
+    // Wait on a caller-owned counter
+    atomic_store(&pending_batch, JOBS);
+    for (int i = 0; i < JOBS; i++)
+        lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, slow_job, NULL));
+    lum_scheduler_wait_until(scheduler, &pending_batch);
+    ASSERT_TRUE(atomic_load(&fast_counter) == 2 * JOBS);
+
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+static void *background_job(void *arg)
+{
+    (void) arg;
+    lum_thread_sleep(100);
+    return NULL;
+}
+
+static bool test_scheduler_wait_counter(void)
+{
+    enum { BACKGROUND = 2, FRAME_JOBS = 64 };
+
+    lum_scheduler_config_t config = {0};
+    config.num_threads            = 4;
+    config.queue_capacity         = 256;
+
+    lum_scheduler_t *scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+    atomic_store(&fast_counter, 0);
+
+    lum_counter_t background, frame;
+    lum_counter_init(&background);
+    lum_counter_init(&frame);
+    ASSERT_TRUE(lum_counter_done(&frame));
+
+    for (int i = 0; i < BACKGROUND; i++)
+        lum_scheduler_submit_counted(scheduler,
+                                     lum_scheduler_create_job(scheduler, background_job, NULL),
+                                     &background);
+    for (int i = 0; i < FRAME_JOBS; i++)
+        lum_scheduler_submit_counted(scheduler, lum_scheduler_create_job(scheduler, fast_job, NULL),
+                                     &frame);
+
+    // The frame batch completes while background work is still in flight
+    lum_scheduler_wait_counter(scheduler, &frame);
+    ASSERT_TRUE(atomic_load(&fast_counter) == FRAME_JOBS);
+    ASSERT_TRUE(!lum_counter_done(&background));
+
+    lum_scheduler_wait_counter(scheduler, &background);
+    ASSERT_TRUE(lum_counter_done(&background));
+
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+#define BATCH_JOBS 256
+
+// Fans out a batch from inside a worker (published to its local deque in one go)
+static void *batch_spawning_job(void *arg)
+{
+    lum_counter_t *counter = arg;
+    Job           *children[BATCH_JOBS / 4];
+    for (int i = 0; i < BATCH_JOBS / 4; i++)
+        children[i] = lum_scheduler_create_job(spawn_scheduler, fast_job, NULL);
+    lum_scheduler_submit_batch_counted(spawn_scheduler, children, BATCH_JOBS / 4, counter);
+    return NULL;
+}
+
+static bool test_scheduler_batch_submit(void)
+{
+    atomic_store(&fast_counter, 0);
+
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads            = 4;
+    config.queue_capacity         = 1024;
+
+    spawn_scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(spawn_scheduler);
+
+    lum_counter_t counter;
+    lum_counter_init(&counter);
+
+    // External batch with a dependent pair: the child is held back until its parent ran
+    Job *jobs[BATCH_JOBS];
+    for (int i = 0; i < BATCH_JOBS; i++)
+        jobs[i] = lum_scheduler_create_job(spawn_scheduler, fast_job, NULL);
+    ASSERT_TRUE(lum_job_add_dependency(jobs[0], jobs[BATCH_JOBS / 2]));
+    lum_scheduler_submit_batch_counted(spawn_scheduler, jobs, BATCH_JOBS, &counter);
+    lum_scheduler_wait_counter(spawn_scheduler, &counter);
+    ASSERT_TRUE(atomic_load(&fast_counter) == BATCH_JOBS);
+
+    // Nested batches submitted from workers count against the same counter
+    Job *spawners[4];
+    for (int i = 0; i < 4; i++)
+        spawners[i] = lum_scheduler_create_job(spawn_scheduler, batch_spawning_job, &counter);
+    lum_scheduler_submit_batch(spawn_scheduler, spawners, 4);
+    lum_scheduler_wait_completion(spawn_scheduler);
+    ASSERT_TRUE(lum_counter_done(&counter));
+    ASSERT_TRUE(atomic_load(&fast_counter) == 2 * BATCH_JOBS);
+
+    lum_scheduler_destroy(spawn_scheduler);
+    spawn_scheduler = NULL;
+    return true;
+}
+
+static atomic_bool gate_open = false;
+
+// Keeps the only worker busy until the test has queued everything
+static void *gate_job(void *arg)
+{
+    (void) arg;
+    while (!atomic_load(&gate_open))
+        lum_thread_yield();
+    return NULL;
+}
+
+static bool test_scheduler_priority_queues(void)
+{
+    enum { PER_CLASS = 16, JOBS = PER_CLASS * LUM_JOB_PRIORITY_COUNT };
+
+    lum_scheduler_config_t config = {0};
+    config.queue_type             = LUM_QUEUE_PRIORITY;
+    config.num_threads            = 1;
+    config.queue_capacity         = 64;
+
+    lum_scheduler_t *scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+    ASSERT_TRUE(scheduler->queue_count == LUM_JOB_PRIORITY_COUNT);
+
+    atomic_store(&gate_open, false);
+    lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, gate_job, NULL));
+
+    // Queued lowest class first; must run highest class first
+    atomic_int clock = 0;
+    OrderArg   args[JOBS];
+    Job       *jobs[JOBS];
+    for (int i = 0; i < JOBS; i++)
+    {
+        lum_job_priority_t priority = LUM_JOB_PRIORITY_BACKGROUND - i / PER_CLASS;
+        args[i]                     = (OrderArg){&clock, -1};
+        jobs[i]                     = lum_scheduler_create_job(scheduler, ordered_job, &args[i]);
+        lum_job_set_priority(jobs[i], priority);
+    }
+    lum_scheduler_submit_batch(scheduler, jobs, JOBS);
+    atomic_store(&gate_open, true);
+    lum_scheduler_wait_completion(scheduler);
+
+    for (int i = 0; i < JOBS; i++)
+    {
+        int class = LUM_JOB_PRIORITY_COUNT - 1 - i / PER_CLASS; // Classes run in this order
+        ASSERT_TRUE(args[i].stamp / PER_CLASS == class);
+    }
+
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+static bool test_topology_query(void)
+{
+    lum_topology_t topology;
+    lum_topology_query(&topology);
+
+    ASSERT_TRUE(topology.node_count >= 1 && topology.node_count <= LUM_MAX_NUMA_NODES);
+    ASSERT_TRUE(topology.cpu_count >= 1 && topology.cpu_count <= LUM_MAX_CPUS);
+    ASSERT_TRUE(topology.node_offset[0] == 0);
+    ASSERT_TRUE(topology.node_offset[topology.node_count] == topology.cpu_count);
+    for (int n = 0; n < topology.node_count; n++)
+        ASSERT_TRUE(topology.node_offset[n] < topology.node_offset[n + 1]); // No empty nodes
+    for (int i = 0; i < topology.cpu_count; i++)
+        ASSERT_TRUE(topology.cpus[i] >= 0);
+    return true;
+}
+
+static bool test_scheduler_numa_aware(void)
+{
+    atomic_store(&fast_counter, 0);
+
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads            = 4;
+    config.queue_capacity         = 1024;
+    config.numa_aware             = true;
+
+    spawn_scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(spawn_scheduler);
+    ASSERT_TRUE(spawn_scheduler->node_count >= 1);
+    for (size_t i = 0; i < config.num_threads; i++)
+    {
+        ASSERT_TRUE(config.threads[i].type == LUM_THREAD_NUMA);
+        ASSERT_TRUE(config.threads[i].numa_node < (int) spawn_scheduler->node_count);
+    }
+
+    for (int i = 0; i < SPAWN_ROOTS; i++)
+        lum_scheduler_submit(spawn_scheduler,
+                             lum_scheduler_create_job(spawn_scheduler, spawning_job, NULL));
+    lum_scheduler_wait_completion(spawn_scheduler);
+    lum_scheduler_destroy(spawn_scheduler);
+    spawn_scheduler = NULL;
+
+    ASSERT_TRUE(atomic_load(&fast_counter) == SPAWN_ROOTS * (SPAWN_CHILDREN + 1));
+    return true;
+}
+
+#define FIBER_FANOUT 4
+#define FIBER_DEPTH 3
+
+static lum_scheduler_t *fiber_scheduler = NULL;
+static atomic_int       fiber_leaves    = 0;
+static atomic_int       fiber_resumed   = 0;
+
+// Tree node: spawns children and waits for them, which parks the job's fiber
+static void *fiber_tree_job(void *arg)
+{
+    int depth = (int) (intptr_t) arg;
+    if (depth == 0)
+    {
+        atomic_fetch_add(&fiber_leaves, 1);
+        return NULL;
+    }
+
+    lum_counter_t children;
+    lum_counter_init(&children);
+    for (int i = 0; i < FIBER_FANOUT; i++)
+    {
+        Job *child = lum_scheduler_create_job(fiber_scheduler, fiber_tree_job,
+                                              (void *) (intptr_t) (depth - 1));
+        lum_scheduler_submit_counted(fiber_scheduler, child, &children);
+    }
+    lum_scheduler_wait_counter(fiber_scheduler, &children);
+    if (lum_counter_done(&children))
+        atomic_fetch_add(&fiber_resumed, 1);
+    return NULL;
+}
+
+static bool test_scheduler_fibers(void)
+{
+    enum { ROOTS = 16 };
+
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_WORK_STEALING;
+    config.use_fibers             = true;
+    config.num_threads            = 2;
+    config.queue_capacity         = 1024;
+    config.fiber_count            = 128;
+
+    fiber_scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(fiber_scheduler);
+    ASSERT_NOT_NULL(fiber_scheduler->fibers);
+    atomic_store(&fiber_leaves, 0);
+    atomic_store(&fiber_resumed, 0);
+
+    // Far more waiting jobs than workers: only works if waits suspend instead of block
+    for (int i = 0; i < ROOTS; i++)
+        lum_scheduler_submit(fiber_scheduler, lum_scheduler_create_job(
+                                                  fiber_scheduler, fiber_tree_job,
+                                                  (void *) (intptr_t) FIBER_DEPTH));
+    lum_scheduler_wait_completion(fiber_scheduler);
+
+    int leaves = ROOTS, inner = 0;
+    for (int d = 0; d < FIBER_DEPTH; d++)
+    {
+        inner += leaves;
+        leaves *= FIBER_FANOUT;
+    }
+    ASSERT_TRUE(atomic_load(&fiber_leaves) == leaves);
+    ASSERT_TRUE(atomic_load(&fiber_resumed) == inner);
+
+    lum_scheduler_destroy(fiber_scheduler);
+    fiber_scheduler = NULL;
+    return true;
+}
+
+static bool test_scheduler_stats(void)
+{
+    enum { EXTRA = 10, CAPACITY = 4 };
+
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_ROUND_ROBIN;
+    config.num_threads            = 1;
+    config.queue_capacity         = CAPACITY;
+
+    lum_scheduler_t *scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+
+    // The only worker is held up, so the queue fills and the rest spills
+    atomic_store(&gate_open, false);
+    atomic_store(&fast_counter, 0);
+    lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, gate_job, NULL));
+    for (int i = 0; i < EXTRA; i++)
+        lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, fast_job, NULL));
+    atomic_store(&gate_open, true);
+    lum_scheduler_wait_completion(scheduler);
+    lum_thread_sleep(10); // Let the worker go idle
+
+    lum_scheduler_stats_t stats, worker;
+    lum_scheduler_get_stats(scheduler, &stats);
+    lum_scheduler_stats_t unused;
+    ASSERT_TRUE(!lum_scheduler_get_worker_stats(scheduler, 1, &unused));
+    ASSERT_TRUE(lum_scheduler_get_worker_stats(scheduler, 0, &worker));
+
+    ASSERT_TRUE(atomic_load(&fast_counter) == EXTRA);
+    ASSERT_TRUE(stats.queue_full >= EXTRA - CAPACITY && stats.queue_full <= EXTRA - CAPACITY + 1);
+    ASSERT_TRUE(stats.jobs_executed == EXTRA + 1);
+    ASSERT_TRUE(worker.jobs_executed == stats.jobs_executed);
+    ASSERT_TRUE(stats.max_queue_depth == CAPACITY);
+    ASSERT_TRUE(stats.idle_ns >= 1000000); // Counted while the worker is still parked
+    ASSERT_TRUE(stats.busy_ns > 0);
+    lum_scheduler_destroy(scheduler);
+
+    // Steal counters on a work-stealing scheduler
+    config                = (lum_scheduler_config_t){0};
+    config.type           = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads    = 4;
+    config.queue_capacity = 1024;
+    scheduler             = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+    atomic_store(&fast_counter, 0);
+    for (int i = 0; i < 512; i++)
+        lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, fast_job, NULL));
+    lum_scheduler_wait_completion(scheduler);
+
+    lum_scheduler_get_stats(scheduler, &stats);
+    ASSERT_TRUE(stats.jobs_executed == 512);
+    ASSERT_TRUE(stats.queue_full == 0);
+    ASSERT_TRUE(stats.steals <= stats.steal_attempts);
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+// Queue overflow: every job of a burst far larger than the queue runs, in order per class
+static atomic_int overflow_next = 0;
+static atomic_int overflow_out_of_order = 0;
+
+static void *overflow_ordered_job(void *arg)
+{
+    int expected = (int) (intptr_t) arg;
+    if (atomic_fetch_add(&overflow_next, 1) != expected)
+        atomic_fetch_add(&overflow_out_of_order, 1);
+    return NULL;
+}
+
+static int overflow_children = 4096; // Jobs each overflow_spawner_job submits
+
+static void *overflow_spawner_job(void *arg)
+{
+    lum_scheduler_t *scheduler = (lum_scheduler_t *) arg;
+    for (int i = 0; i < overflow_children; i++)
+        lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, fast_job, NULL));
+    return NULL;
+}
+
+static bool test_scheduler_queue_overflow(void)
+{
+    enum { BURST = 100000, CAPACITY = 64 };
+
+    // Spill: one worker so the spilled jobs must come out in submission order
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_ROUND_ROBIN;
+    config.num_threads            = 1;
+    config.queue_capacity         = CAPACITY;
+
+    lum_scheduler_t *scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+    atomic_store(&gate_open, false);
+    atomic_store(&overflow_next, 0);
+    atomic_store(&overflow_out_of_order, 0);
+    lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, gate_job, NULL));
+    for (int i = 0; i < BURST; i++)
+        lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, overflow_ordered_job,
+                                                                 (void *) (intptr_t) i));
+    atomic_store(&gate_open, true);
+    lum_scheduler_wait_completion(scheduler);
+    ASSERT_TRUE(atomic_load(&overflow_next) == BURST);
+    ASSERT_TRUE(atomic_load(&overflow_out_of_order) == 0);
+
+    lum_scheduler_stats_t stats;
+    lum_scheduler_get_stats(scheduler, &stats);
+    ASSERT_TRUE(stats.queue_full >= BURST - CAPACITY);
+    lum_scheduler_destroy(scheduler);
+
+    // Block: submitters wait for room, workers submitting from jobs help instead
+    config                 = (lum_scheduler_config_t){0};
+    config.type            = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads     = 2;
+    config.queue_capacity  = CAPACITY;
+    config.overflow_policy = LUM_OVERFLOW_BLOCK;
+    scheduler              = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+    atomic_store(&fast_counter, 0);
+    overflow_children = 4096;
+    for (int i = 0; i < BURST / 10; i++)
+        lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, fast_job, NULL));
+    for (int i = 0; i < 4; i++)
+        lum_scheduler_submit(scheduler,
+                             lum_scheduler_create_job(scheduler, overflow_spawner_job, scheduler));
+    lum_scheduler_wait_completion(scheduler);
+    ASSERT_TRUE(atomic_load(&fast_counter) == BURST / 10 + 4 * 4096);
+    lum_scheduler_destroy(scheduler);
+
+    // Block with many spawners on small fiber stacks: a spawner run to make room must not run
+    // another spawner on the same stack in turn, or the nesting overflows the fiber
+    enum { SPAWNERS = 1024, CHILDREN = 256 };
+    config                  = (lum_scheduler_config_t){0};
+    config.type             = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads      = 2;
+    config.queue_capacity   = CAPACITY;
+    config.overflow_policy  = LUM_OVERFLOW_BLOCK;
+    config.use_fibers       = true;
+    config.fiber_stack_size = 32 * 1024;
+    scheduler               = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+    atomic_store(&fast_counter, 0);
+    overflow_children = CHILDREN;
+    for (int i = 0; i < SPAWNERS; i++)
+        lum_scheduler_submit(scheduler,
+                             lum_scheduler_create_job(scheduler, overflow_spawner_job, scheduler));
+    lum_scheduler_wait_completion(scheduler);
+    ASSERT_TRUE(atomic_load(&fast_counter) == SPAWNERS * CHILDREN);
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+#ifdef USE_SCHEDULER_TRACE
+static size_t count_occurrences(const char *text, const char *pattern)
+{
+    size_t count = 0;
+    for (const char *at = strstr(text, pattern); at; at = strstr(at + 1, pattern))
+        count++;
+    return count;
+}
+#endif
+
+static bool test_scheduler_trace_export(void)
+{
+    enum { JOBS = 200 };
+
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads            = 2;
+    config.queue_capacity         = 256;
+
+    lum_scheduler_t *scheduler = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+    atomic_store(&fast_counter, 0);
+    for (int i = 0; i < JOBS; i++)
+        lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, fast_job, NULL));
+    lum_scheduler_wait_completion(scheduler);
+    ASSERT_TRUE(atomic_load(&fast_counter) == JOBS);
+
+    FILE *file = tmpfile();
+    ASSERT_NOT_NULL(file);
+#ifndef USE_SCHEDULER_TRACE
+    ASSERT_TRUE(!lum_scheduler_trace_export(scheduler, file));
+#else
+    ASSERT_TRUE(lum_scheduler_trace_export(scheduler, file));
+    lum_scheduler_destroy(scheduler); // Workers stop recording
+    scheduler = NULL;
+
+    long size = ftell(file);
+    ASSERT_TRUE(size > 0);
+    char *text = malloc((size_t) size + 1);
+    ASSERT_NOT_NULL(text);
+    rewind(file);
+    ASSERT_TRUE(fread(text, 1, (size_t) size, file) == (size_t) size);
+    text[size] = '\0';
+
+    // Every job shows up as one begin/end pair on some worker
+    ASSERT_TRUE(strncmp(text, "{\"displayTimeUnit\"", 18) == 0);
+    ASSERT_TRUE(count_occurrences(text, "\"thread_name\"") == 2);
+    ASSERT_TRUE(count_occurrences(text, "\"ph\":\"B\",\"cat\":\"job\"") == JOBS);
+    ASSERT_TRUE(count_occurrences(text, "\"ph\":\"E\",\"cat\":\"job\"") == JOBS);
+    ASSERT_TRUE(strcmp(text + size - 4, "\n]}\n") == 0);
+    free(text);
+#endif
+    fclose(file);
+
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+static bool test_job_pool_reuse(void)
+{
+    enum { CAPACITY = 64 };
+
+    lum_allocator *allocator = lum_create_default_allocator();
+    lum_job_pool_t owner, other;
+    ASSERT_TRUE(lum_job_pool_init(&owner, CAPACITY, allocator));
+    ASSERT_TRUE(lum_job_pool_init(&other, CAPACITY, allocator));
+
+    Job *jobs[CAPACITY];
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        jobs[i] = lum_job_pool_alloc(&owner);
+        ASSERT_NOT_NULL(jobs[i]);
+        ASSERT_TRUE(((uintptr_t) jobs[i] & 63) == 0);
+        ASSERT_TRUE((jobs[i]->flags & LUM_JOB_FLAG_HEAP) == 0);
+    }
+
+    // Exhausted: falls back to the general allocator
+    Job *heap = lum_job_pool_alloc(&owner);
+    ASSERT_NOT_NULL(heap);
+    ASSERT_TRUE(heap->flags & LUM_JOB_FLAG_HEAP);
+    lum_job_pool_free(&owner, heap);
+
+    // Half come back through another pool's batches, half from a thread without a pool
+    for (int i = 0; i < CAPACITY / 2; i++)
+        lum_job_pool_free(&other, jobs[i]);
+    lum_job_pool_flush(&other);
+    for (int i = CAPACITY / 2; i < CAPACITY; i++)
+        lum_job_pool_free(NULL, jobs[i]);
+
+    // Everything is reusable again
+    for (int i = 0; i < CAPACITY; i++)
+    {
+        jobs[i] = lum_job_pool_alloc(&owner);
+        ASSERT_TRUE((jobs[i]->flags & LUM_JOB_FLAG_HEAP) == 0);
+    }
+
+    lum_job_pool_destroy(&owner);
+    lum_job_pool_destroy(&other);
+    lum_allocator_destroy(allocator);
+    return true;
+}
+
+// Scheduler manager: jobs run on the scheduler their tag is routed to, whose workers stay on
+// their own CPU set
+#define TAG_RENDER 0
+#define TAG_BACKGROUND 5
+
+static bool test_scheduler_manager(void)
+{
+    atomic_store(&fast_counter, 0);
+
+    lum_topology_t topology;
+    lum_topology_query(&topology);
+    int render_cpus[]     = {topology.cpus[0]};
+    int background_cpus[] = {topology.cpus[topology.cpu_count - 1]};
+
+    lum_scheduler_config_t render = {0}, background = {0};
+    render.type                   = LUM_SCHEDULER_WORK_STEALING;
+    render.num_threads            = 2;
+    render.cpus                   = render_cpus;
+    render.cpu_count              = 1;
+    background.num_threads        = 1;
+    background.cpus               = background_cpus;
+    background.cpu_count          = 1;
+
+    lum_scheduler_manager_t manager;
+    lum_scheduler_manager_init(&manager);
+    lum_scheduler_t *render_scheduler     = lum_scheduler_manager_add(&manager, &render);
+    lum_scheduler_t *background_scheduler = lum_scheduler_manager_add(&manager, &background);
+    ASSERT_NOT_NULL(render_scheduler);
+    ASSERT_NOT_NULL(background_scheduler);
+    ASSERT_TRUE(lum_scheduler_manager_route(&manager, TAG_BACKGROUND, background_scheduler));
+    ASSERT_TRUE(!lum_scheduler_manager_route(&manager, LUM_MAX_JOB_TAGS, background_scheduler));
+    ASSERT_TRUE(lum_scheduler_manager_get(&manager, TAG_RENDER) == render_scheduler);
+    ASSERT_TRUE(lum_scheduler_manager_get(&manager, 7) == render_scheduler); // Unrouted
+
+    for (size_t i = 0; i < render.num_threads; i++)
+    {
+        ASSERT_TRUE(render.threads[i].type == LUM_THREAD_PINNED);
+        ASSERT_TRUE(render.threads[i].cpu == -1 || render.threads[i].cpu == render_cpus[0]);
+    }
+    ASSERT_TRUE(background.threads[0].cpu == -1 || background.threads[0].cpu == background_cpus[0]);
+
+    for (int i = 0; i < 60; i++)
+    {
+        uint32_t tag = i % 3 == 0 ? TAG_BACKGROUND : TAG_RENDER;
+        lum_scheduler_manager_submit(
+            &manager, tag, lum_scheduler_manager_create_job(&manager, tag, fast_job, NULL));
+    }
+    lum_scheduler_manager_wait_completion(&manager);
+
+    lum_scheduler_stats_t render_stats, background_stats;
+    lum_scheduler_get_stats(render_scheduler, &render_stats);
+    lum_scheduler_get_stats(background_scheduler, &background_stats);
+    ASSERT_TRUE(atomic_load(&fast_counter) == 60);
+    ASSERT_TRUE(render_stats.jobs_executed == 40);
+    ASSERT_TRUE(background_stats.jobs_executed == 20);
+
+    lum_scheduler_manager_destroy(&manager);
+    ASSERT_TRUE(manager.count == 0);
+    return true;
+}
+
+// Continuations: pipelines whose first stage alone is submitted run every stage in order, on the
+// worker that ran the previous one, and the head's counter covers the whole chain
+#define PIPELINES 64
+#define PIPELINE_STAGES 3
+
+static THREAD_LOCAL int pipeline_thread_marker;
+
+typedef struct
+{
+    int  stage;                    // Stages run so far
+    int *threads[PIPELINE_STAGES]; // Thread each stage ran on
+} Pipeline;
+
+static void *pipeline_stage(void *arg)
+{
+    Pipeline *pipeline                   = (Pipeline *) arg;
+    pipeline->threads[pipeline->stage++] = &pipeline_thread_marker;
+    return NULL;
+}
+
+static bool test_job_continuations(void)
+{
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads            = 4;
+    lum_scheduler_t *scheduler    = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+
+    static Pipeline pipelines[PIPELINES];
+    memset(pipelines, 0, sizeof(pipelines));
+    lum_counter_t counter;
+    lum_counter_init(&counter);
+    for (int p = 0; p < PIPELINES; p++)
+    {
+        Job *stages[PIPELINE_STAGES];
+        for (int i = 0; i < PIPELINE_STAGES; i++)
+        {
+            stages[i] = lum_scheduler_create_job(scheduler, pipeline_stage, &pipelines[p]);
+            if (i > 0)
+                ASSERT_TRUE(lum_job_then(stages[i - 1], stages[i]));
+        }
+        ASSERT_TRUE(!lum_job_then(stages[0], stages[2])); // One continuation per job
+        lum_scheduler_submit_counted(scheduler, stages[0], &counter);
+    }
+    lum_scheduler_wait_counter(scheduler, &counter);
+
+    for (int p = 0; p < PIPELINES; p++)
+    {
+        ASSERT_TRUE(pipelines[p].stage == PIPELINE_STAGES);
+        for (int i = 1; i < PIPELINE_STAGES; i++)
+            ASSERT_TRUE(pipelines[p].threads[i] == pipelines[p].threads[0]);
+    }
+    lum_scheduler_wait_completion(scheduler); // jobs_remaining balanced
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+// Cancellation: queued jobs holding a cancelled token are skipped, their continuations too, while
+// everything still completes
+static atomic_bool cancel_gate_open = false;
+
+static void *cancel_gate_job(void *arg)
+{
+    (void) arg;
+    while (!atomic_load(&cancel_gate_open))
+        lum_thread_yield();
+    return NULL;
+}
+
+static bool test_job_cancellation(void)
+{
+    atomic_store(&fast_counter, 0);
+    atomic_store(&cancel_gate_open, false);
+
+    lum_scheduler_config_t config = {0};
+    config.num_threads            = 1;
+    lum_scheduler_t *scheduler    = lum_scheduler_create(&config);
+    ASSERT_NOT_NULL(scheduler);
+
+    // The only worker is stuck in the gate, so everything below stays queued
+    lum_scheduler_submit(scheduler, lum_scheduler_create_job(scheduler, cancel_gate_job, NULL));
+
+    lum_cancel_token_t token, other;
+    lum_cancel_token_init(&token);
+    lum_cancel_token_init(&other);
+    lum_counter_t counter;
+    lum_counter_init(&counter);
+    for (int i = 0; i < 50; i++)
+    {
+        Job *job  = lum_scheduler_create_job(scheduler, fast_job, NULL);
+        Job *then = lum_scheduler_create_job(scheduler, fast_job, NULL);
+        lum_job_set_cancel_token(job, i % 2 ? &token : &other);
+        lum_job_then(job, then); // Inherits the token
+        lum_scheduler_submit_counted(scheduler, job, &counter);
+    }
+    lum_cancel_token_cancel(&token);
+    ASSERT_TRUE(lum_cancel_token_cancelled(&token) && !lum_cancel_token_cancelled(&other));
+    atomic_store(&cancel_gate_open, true);
+    lum_scheduler_wait_counter(scheduler, &counter);
+    lum_scheduler_wait_completion(scheduler);
+
+    lum_scheduler_stats_t stats;
+    lum_scheduler_get_stats(scheduler, &stats);
+    ASSERT_TRUE(atomic_load(&fast_counter) == 50); // 25 jobs and their continuations
+    ASSERT_TRUE(stats.jobs_cancelled == 50);
+    ASSERT_TRUE(stats.jobs_executed == 51);
+    lum_scheduler_destroy(scheduler);
+    return true;
+}
+
+// Scratch arenas: jobs get a private linear allocator that is rewound when they return. In
+// fiber mode it travels with the job across suspensions.
+#define SCRATCH_BYTES 1024
+#define SCRATCH_CHILDREN 8
+
+static lum_scheduler_t *scratch_scheduler = NULL;
+static void *volatile   scratch_first     = NULL;
+static atomic_int       scratch_failures  = 0;
+
+static unsigned char *scratch_fill(unsigned char pattern)
+{
+    lum_allocator *scratch = lum_scheduler_scratch();
+    unsigned char *bytes   = scratch ? scratch->alloc(scratch, SCRATCH_BYTES, 16) : NULL;
+    if (!bytes)
+    {
+        atomic_fetch_add(&scratch_failures, 1);
+        return NULL;
+    }
+    memset(bytes, pattern, SCRATCH_BYTES);
+    return bytes;
+}
+
+static void *scratch_record_job(void *arg)
+{
+    (void) arg;
+    unsigned char *a = scratch_fill(1);
+    unsigned char *b = scratch_fill(2);
+    if (a == b || (scratch_first && scratch_first != a))
+        atomic_fetch_add(&scratch_failures, 1); // Not rewound after the previous job
+    scratch_first = a;
+    return NULL;
+}
+
+static void *scratch_child_job(void *arg)
+{
+    scratch_fill((unsigned char) (intptr_t) arg);
+    return NULL;
+}
+
+static void *scratch_parent_job(void *arg)
+{
+    unsigned char  pattern = (unsigned char) (intptr_t) arg;
+    unsigned char *bytes   = scratch_fill(pattern);
+
+    lum_counter_t counter;
+    lum_counter_init(&counter);
+    for (int i = 0; i < SCRATCH_CHILDREN; i++)
+        lum_scheduler_submit_counted(
+            scratch_scheduler,
+            lum_scheduler_create_job(scratch_scheduler, scratch_child_job, (void *) (intptr_t) i),
+            &counter);
+    lum_scheduler_wait_counter(scratch_scheduler, &counter); // Suspends in fiber mode
+
+    for (int i = 0; bytes && i < SCRATCH_BYTES; i++)
+    {
+        if (bytes[i] != pattern)
+        {
+            atomic_fetch_add(&scratch_failures, 1);
+            break;
+        }
+    }
+    return NULL;
+}
+
+static bool test_scheduler_scratch(void)
+{
+    ASSERT_TRUE(lum_scheduler_scratch() == NULL); // Not a worker
+
+    for (int fibers = 0; fibers < 2; fibers++)
+    {
+        atomic_store(&scratch_failures, 0);
+        scratch_first = NULL;
+
+        lum_scheduler_config_t config = {0};
+        config.type                   = LUM_SCHEDULER_WORK_STEALING;
+        config.num_threads            = fibers ? 2 : 1;
+        config.use_fibers             = fibers;
+        config.help_while_waiting     = !fibers; // Waiting parents run their children
+        config.scratch_size           = 4 * SCRATCH_BYTES;
+        scratch_scheduler             = lum_scheduler_create(&config);
+        ASSERT_NOT_NULL(scratch_scheduler);
+
+        if (!fibers)
+        {
+            // One worker: every job starts from the same rewound arena
+            for (int i = 0; i < 16; i++)
+                lum_scheduler_submit(scratch_scheduler,
+                                     lum_scheduler_create_job(scratch_scheduler,
+                                                              scratch_record_job, NULL));
+            while (atomic_load(&scratch_scheduler->jobs_remaining) > 0)
+                lum_thread_sleep(1);
+            ASSERT_NOT_NULL(scratch_first);
+        }
+        // Nested arena use: children run on top of a waiting parent's allocation
+        lum_counter_t parents;
+        lum_counter_init(&parents);
+        for (int i = 0; i < 8; i++)
+            lum_scheduler_submit_counted(
+                scratch_scheduler,
+                lum_scheduler_create_job(scratch_scheduler, scratch_parent_job,
+                                         (void *) (intptr_t) (0x80 + i)),
+                &parents);
+        while (!lum_counter_done(&parents)) // Not helping: this thread has no arena
+            lum_thread_sleep(1);
+        ASSERT_TRUE(atomic_load(&scratch_failures) == 0);
+
+        lum_scheduler_destroy(scratch_scheduler);
+        scratch_scheduler = NULL;
+    }
+    return true;
+}
+
 // **Define test cases**
 TestCase lum_scheduler_tests[] = {
     {"test_scheduler_basic_execution", test_scheduler_basic_execution},
     {"test_scheduler_multithreading", test_scheduler_multithreading},
-    {"test_scheduler_stress", test_scheduler_stress}};
+    {"test_scheduler_stress", test_scheduler_stress},
+    {"test_scheduler_work_stealing", test_scheduler_work_stealing},
+    {"test_scheduler_dependencies", test_scheduler_dependencies},
+    {"test_job_pool_reuse", test_job_pool_reuse},
+    {"test_scheduler_wait_policies", test_scheduler_wait_policies},
+    {"test_scheduler_park_wake", test_scheduler_park_wake},
+    {"test_scheduler_help_while_waiting", test_scheduler_help_while_waiting},
+    {"test_scheduler_wait_counter", test_scheduler_wait_counter},
+    {"test_scheduler_batch_submit", test_scheduler_batch_submit},
+    {"test_scheduler_priority_queues", test_scheduler_priority_queues},
+    {"test_topology_query", test_topology_query},
+    {"test_scheduler_numa_aware", test_scheduler_numa_aware},
+    {"test_scheduler_fibers", test_scheduler_fibers},
+    {"test_scheduler_trace_export", test_scheduler_trace_export},
+    {"test_scheduler_stats", test_scheduler_stats},
+    {"test_scheduler_queue_overflow", test_scheduler_queue_overflow},
+    {"test_scheduler_manager", test_scheduler_manager},
+    {"test_job_continuations", test_job_continuations},
+    {"test_job_cancellation", test_job_cancellation},
+    {"test_scheduler_scratch", test_scheduler_scratch}};
 
 // **Test runner function**
 int lum_scheduler_tests_count = sizeof(lum_scheduler_tests) / sizeof(TestCase);
\ No newline at end of file
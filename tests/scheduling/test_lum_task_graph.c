@@ -0,0 +1,160 @@
+#include "../memory/allocators/mem_alloc.h"
+#include "../test_framework.h"
+#include "lum_scheduler.h"
+#include "lum_task_graph.h"
+
+#include <stdatomic.h>
+
+#define GRAPH_FRAMES 200
+#define GRAPH_FANOUT 12
+#define GRAPH_TASKS  (5 + GRAPH_FANOUT)
+
+typedef struct
+{
+    atomic_int *clock; // Shared ordering clock
+    int         stamp; // Clock value when the task ran
+    int         runs;
+    int         frame;
+} GraphTask;
+
+static void *graph_task(void *arg)
+{
+    GraphTask *task = (GraphTask *) arg;
+    task->stamp     = atomic_fetch_add(task->clock, 1);
+    task->runs++;
+    return NULL;
+}
+
+static lum_scheduler_t *create_scheduler(void)
+{
+    static lum_scheduler_config_t config;
+    config                = (lum_scheduler_config_t){0};
+    config.type           = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads    = 4;
+    config.queue_capacity = 256;
+    return lum_scheduler_create(&config);
+}
+
+// Diamond (a -> b, c -> d) followed by a fan-out from d and a join of the fan-out into e
+static bool test_task_graph_replay(void)
+{
+    lum_allocator   *allocator = lum_create_default_allocator();
+    lum_scheduler_t *scheduler = create_scheduler();
+    ASSERT_NOT_NULL(scheduler);
+
+    lum_task_graph_t *graph = lum_task_graph_create(allocator, GRAPH_TASKS, 4 + 2 * GRAPH_FANOUT);
+    ASSERT_NOT_NULL(graph);
+
+    atomic_int clock = 0;
+    GraphTask  tasks[GRAPH_TASKS];
+    int        ids[GRAPH_TASKS];
+    for (int i = 0; i < GRAPH_TASKS; i++)
+    {
+        tasks[i] = (GraphTask){&clock, -1, 0, 0};
+        // Record the join first so ids do not follow execution order
+        int index = i == 0 ? 4 : (i <= 4 ? i - 1 : i);
+        ids[index] = lum_task_graph_add(graph, graph_task, &tasks[index]);
+        ASSERT_TRUE(ids[index] >= 0);
+    }
+    ASSERT_TRUE(lum_task_graph_depend(graph, ids[0], ids[1]));
+    ASSERT_TRUE(lum_task_graph_depend(graph, ids[0], ids[2]));
+    ASSERT_TRUE(lum_task_graph_depend(graph, ids[1], ids[3]));
+    ASSERT_TRUE(lum_task_graph_depend(graph, ids[2], ids[3]));
+    for (int i = 5; i < GRAPH_TASKS; i++)
+    {
+        ASSERT_TRUE(lum_task_graph_depend(graph, ids[3], ids[i]));
+        ASSERT_TRUE(lum_task_graph_depend(graph, ids[i], ids[4]));
+    }
+    ASSERT_TRUE(!lum_task_graph_depend(graph, ids[0], ids[0]));
+    ASSERT_TRUE(lum_task_graph_compile(graph));
+    ASSERT_TRUE(lum_task_graph_add(graph, graph_task, NULL) == -1);
+
+    for (int frame = 0; frame < GRAPH_FRAMES; frame++)
+    {
+        if (frame % 2)
+            lum_task_graph_run(scheduler, graph);
+        else
+        {
+            lum_counter_t counter;
+            lum_counter_init(&counter);
+            lum_task_graph_launch(scheduler, graph, &counter);
+            lum_scheduler_wait_counter(scheduler, &counter);
+        }
+
+        ASSERT_TRUE(tasks[0].stamp < tasks[1].stamp && tasks[0].stamp < tasks[2].stamp);
+        ASSERT_TRUE(tasks[1].stamp < tasks[3].stamp && tasks[2].stamp < tasks[3].stamp);
+        for (int i = 5; i < GRAPH_TASKS; i++)
+        {
+            ASSERT_TRUE(tasks[3].stamp < tasks[i].stamp);
+            ASSERT_TRUE(tasks[i].stamp < tasks[4].stamp);
+        }
+        ASSERT_TRUE(tasks[4].stamp == atomic_load(&clock) - 1);
+    }
+    for (int i = 0; i < GRAPH_TASKS; i++)
+        ASSERT_TRUE(tasks[i].runs == GRAPH_FRAMES);
+
+    lum_task_graph_destroy(graph);
+    lum_scheduler_destroy(scheduler);
+    lum_allocator_destroy(allocator);
+    return true;
+}
+
+static bool test_task_graph_cycle(void)
+{
+    lum_allocator    *allocator = lum_create_default_allocator();
+    lum_task_graph_t *graph     = lum_task_graph_create(allocator, 4, 4);
+    ASSERT_NOT_NULL(graph);
+
+    atomic_int clock = 0;
+    GraphTask  task  = {&clock, -1, 0, 0};
+    int        a     = lum_task_graph_add(graph, graph_task, &task);
+    int        b     = lum_task_graph_add(graph, graph_task, &task);
+    int        c     = lum_task_graph_add(graph, graph_task, &task);
+    ASSERT_TRUE(lum_task_graph_depend(graph, a, b));
+    ASSERT_TRUE(lum_task_graph_depend(graph, b, c));
+    ASSERT_TRUE(lum_task_graph_depend(graph, c, b));
+    ASSERT_TRUE(!lum_task_graph_depend(graph, a, 7));
+    ASSERT_TRUE(!lum_task_graph_compile(graph));
+
+    lum_task_graph_destroy(graph);
+    lum_allocator_destroy(allocator);
+    return true;
+}
+
+static bool test_task_graph_set_data(void)
+{
+    lum_allocator   *allocator = lum_create_default_allocator();
+    lum_scheduler_t *scheduler = create_scheduler();
+    ASSERT_NOT_NULL(scheduler);
+
+    lum_task_graph_t *graph = lum_task_graph_create(allocator, 2, 1);
+    ASSERT_NOT_NULL(graph);
+
+    atomic_int clock = 0;
+    GraphTask  first = {&clock, -1, 0, 0}, second = {&clock, -1, 0, 0};
+    int        a     = lum_task_graph_add(graph, graph_task, &first);
+    int        b     = lum_task_graph_add(graph, graph_task, &first);
+    ASSERT_TRUE(lum_task_graph_depend(graph, a, b));
+    ASSERT_TRUE(lum_task_graph_compile(graph));
+
+    lum_task_graph_run(scheduler, graph);
+    ASSERT_TRUE(first.runs == 2);
+
+    lum_task_graph_set_data(graph, b, &second);
+    lum_task_graph_run(scheduler, graph);
+    ASSERT_TRUE(first.runs == 3 && second.runs == 1);
+    ASSERT_TRUE(first.stamp < second.stamp);
+
+    lum_task_graph_destroy(graph);
+    lum_scheduler_destroy(scheduler);
+    lum_allocator_destroy(allocator);
+    return true;
+}
+
+// **Define test cases**
+TestCase lum_task_graph_tests[] = {{"test_task_graph_replay", test_task_graph_replay},
+                                   {"test_task_graph_cycle", test_task_graph_cycle},
+                                   {"test_task_graph_set_data", test_task_graph_set_data}};
+
+// **Test runner function**
+int lum_task_graph_tests_count = sizeof(lum_task_graph_tests) / sizeof(TestCase);
@@ -0,0 +1,240 @@
+#include "../memory/allocators/mem_alloc.h"
+#include "../test_framework.h"
+#include "lum_scheduler.h"
+#include "lum_thread.h"
+#include "lum_timer_wheel.h"
+#include "platform.h"
+
+#include <stdatomic.h>
+
+#define WHEEL_TIMERS 2000
+
+typedef struct
+{
+    lum_timer_t timer;
+    uint64_t    fired_at; // Tick of the advance that returned it, 0 while pending
+    bool        removed;
+} WheelTimer;
+
+// Timers on every level fire exactly once, in the advance that crosses their tick
+static bool test_timer_wheel_ordering(void)
+{
+    static lum_timer_wheel_t wheel;
+    static WheelTimer        timers[WHEEL_TIMERS];
+    const uint64_t           start = 1000;
+    lum_timer_wheel_init(&wheel, start);
+
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < WHEEL_TIMERS; i++)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        // Mostly near, some far enough to cascade through the upper levels
+        uint64_t delay          = (i % 8 == 0) ? (seed % 400000) : (seed % 5000);
+        timers[i].timer.expires = start + 1 + delay;
+        timers[i].fired_at      = 0;
+        timers[i].removed       = false;
+        lum_timer_wheel_add(&wheel, &timers[i].timer);
+    }
+    for (size_t i = 0; i < WHEEL_TIMERS; i += 7)
+    {
+        lum_timer_wheel_remove(&wheel, &timers[i].timer);
+        timers[i].removed = true;
+    }
+
+    uint64_t now = start;
+    while (wheel.count > 0)
+    {
+        uint64_t next = lum_timer_wheel_next_tick(&wheel);
+        ASSERT_TRUE(next > now && next != UINT64_MAX);
+        seed               = seed * 1664525u + 1013904223u;
+        uint64_t     to    = now + 1 + seed % 300;
+        lum_timer_t *fired = lum_timer_wheel_advance(&wheel, to);
+        uint64_t     last  = 0;
+        while (fired)
+        {
+            WheelTimer *timer = (WheelTimer *) fired;
+            fired             = fired->next;
+            ASSERT_TRUE(!timer->removed && timer->fired_at == 0);
+            ASSERT_TRUE(timer->timer.expires > now && timer->timer.expires <= to);
+            ASSERT_TRUE(timer->timer.expires >= last); // Oldest first
+            last            = timer->timer.expires;
+            timer->fired_at = to;
+        }
+        now = to;
+    }
+
+    for (size_t i = 0; i < WHEEL_TIMERS; i++)
+        ASSERT_TRUE(timers[i].removed || timers[i].fired_at != 0);
+    ASSERT_TRUE(lum_timer_wheel_next_tick(&wheel) == UINT64_MAX);
+    return true;
+}
+
+// Late adds fire on the next tick; timers beyond the wheel's range wait at the top level
+static bool test_timer_wheel_edges(void)
+{
+    static lum_timer_wheel_t wheel;
+    lum_timer_wheel_init(&wheel, 50);
+
+    lum_timer_t late = {.expires = 10};
+    lum_timer_wheel_add(&wheel, &late);
+    ASSERT_TRUE(lum_timer_wheel_next_tick(&wheel) == 51);
+    ASSERT_TRUE(lum_timer_wheel_advance(&wheel, 51) == &late);
+
+    uint64_t    far_tick = 50 + (1ull << 26);
+    lum_timer_t far      = {.expires = far_tick};
+    lum_timer_wheel_add(&wheel, &far);
+    ASSERT_TRUE(lum_timer_wheel_advance(&wheel, far_tick - 1) == NULL);
+    ASSERT_TRUE(wheel.count == 1);
+    ASSERT_TRUE(lum_timer_wheel_advance(&wheel, far_tick) == &far);
+    ASSERT_TRUE(wheel.count == 0);
+    return true;
+}
+
+typedef struct
+{
+    atomic_uint_least64_t ran_at;
+    atomic_int            runs;
+} TimerProbe;
+
+static void *timer_probe(void *arg)
+{
+    TimerProbe *probe = (TimerProbe *) arg;
+    atomic_store(&probe->ran_at, lum_time_now_ns());
+    atomic_fetch_add(&probe->runs, 1);
+    return NULL;
+}
+
+static lum_scheduler_t *create_scheduler(lum_scheduler_config_t *config,
+                                         lum_wait_policy_t wait_policy)
+{
+    *config             = (lum_scheduler_config_t){0};
+    config->type        = LUM_SCHEDULER_WORK_STEALING;
+    config->num_threads = 2;
+    config->wait_policy = wait_policy;
+    return lum_scheduler_create(config);
+}
+
+// Delayed jobs wait for their delay, and lum_scheduler_wait_completion waits for them
+static bool test_scheduler_submit_after(void)
+{
+    lum_wait_policy_t policies[] = {LUM_WAIT_COND_VAR, LUM_WAIT_BACKOFF};
+    for (size_t p = 0; p < sizeof(policies) / sizeof(policies[0]); p++)
+    {
+        lum_scheduler_config_t config;
+        lum_scheduler_t       *scheduler = create_scheduler(&config, policies[p]);
+        ASSERT_TRUE(scheduler != NULL);
+        lum_allocator *allocator = config.allocator;
+
+        TimerProbe early = {0}, late = {0};
+        uint64_t   start = lum_time_now_ns();
+        lum_scheduler_submit_after(scheduler,
+                                   lum_scheduler_create_job(scheduler, timer_probe, &late), 40);
+        lum_scheduler_submit_after(scheduler,
+                                   lum_scheduler_create_job(scheduler, timer_probe, &early), 10);
+        lum_scheduler_wait_completion(scheduler);
+
+        ASSERT_TRUE(atomic_load(&early.runs) == 1 && atomic_load(&late.runs) == 1);
+        ASSERT_TRUE(atomic_load(&early.ran_at) - start >= 10 * 1000000ull);
+        ASSERT_TRUE(atomic_load(&late.ran_at) - start >= 40 * 1000000ull);
+        ASSERT_TRUE(atomic_load(&early.ran_at) <= atomic_load(&late.ran_at));
+
+        lum_scheduler_destroy(scheduler);
+        lum_allocator_destroy(allocator);
+    }
+    return true;
+}
+
+// Periodic jobs keep running until cancelled; destroying with timers still armed is fine
+static bool test_scheduler_periodic(void)
+{
+    lum_scheduler_config_t config;
+    lum_scheduler_t       *scheduler = create_scheduler(&config, LUM_WAIT_COND_VAR);
+    ASSERT_TRUE(scheduler != NULL);
+    lum_allocator *allocator = config.allocator;
+
+    TimerProbe       probe = {0}, armed = {0};
+    lum_job_timer_t *timer = lum_scheduler_submit_periodic(scheduler, timer_probe, &probe, 5);
+    ASSERT_TRUE(timer != NULL);
+    ASSERT_TRUE(lum_scheduler_submit_periodic(scheduler, timer_probe, &armed, 100000) != NULL);
+
+    uint64_t start = lum_time_now_ns();
+    while (atomic_load(&probe.runs) < 4 && lum_time_now_ns() - start < 5000000000ull)
+        lum_thread_sleep(1);
+    ASSERT_TRUE(atomic_load(&probe.runs) >= 4);
+    ASSERT_TRUE(lum_time_now_ns() - start >= 15 * 1000000ull); // At least 3 periods apart
+
+    lum_scheduler_cancel_timer(scheduler, timer);
+    lum_scheduler_wait_completion(scheduler); // A run submitted before the cancel may remain
+    int runs = atomic_load(&probe.runs);
+    lum_thread_sleep(20);
+    ASSERT_TRUE(atomic_load(&probe.runs) == runs);
+    ASSERT_TRUE(atomic_load(&armed.runs) == 0);
+
+    lum_scheduler_destroy(scheduler);
+    lum_allocator_destroy(allocator);
+    return true;
+}
+
+static lum_allocator *counted_backing = NULL;
+static atomic_long     counted_live    = 0; // Allocations not yet freed
+
+static void *counted_alloc(lum_allocator *self, size_t size, size_t alignment)
+{
+    (void) self;
+    void *ptr = counted_backing->alloc(counted_backing, size, alignment);
+    if (ptr)
+        atomic_fetch_add(&counted_live, 1);
+    return ptr;
+}
+
+static void counted_free(lum_allocator *self, void *ptr)
+{
+    (void) self;
+    if (ptr)
+        atomic_fetch_sub(&counted_live, 1);
+    counted_backing->free(counted_backing, ptr);
+}
+
+// Destroying with one-shot timers pending frees their jobs, including the ones an exhausted job
+// pool took from the allocator, and continuations that never ran
+static bool test_scheduler_destroy_pending_timers(void)
+{
+    counted_backing         = lum_create_default_allocator();
+    lum_allocator allocator = {.alloc = counted_alloc, .free = counted_free};
+    atomic_store(&counted_live, 0);
+
+    lum_scheduler_config_t config = {0};
+    config.type                   = LUM_SCHEDULER_WORK_STEALING;
+    config.num_threads            = 2;
+    config.job_pool_capacity      = 4;
+    config.allocator              = &allocator;
+    lum_scheduler_t *scheduler    = lum_scheduler_create(&config);
+    ASSERT_TRUE(scheduler != NULL);
+
+    TimerProbe probe = {0};
+    for (int i = 0; i < 32; i++)
+    {
+        Job *job = lum_scheduler_create_job(scheduler, timer_probe, &probe);
+        if (i % 4 == 0)
+            lum_job_then(job, lum_scheduler_create_job(scheduler, timer_probe, &probe));
+        lum_scheduler_submit_after(scheduler, job, 3600 * 1000);
+    }
+    lum_scheduler_destroy(scheduler);
+
+    ASSERT_TRUE(atomic_load(&probe.runs) == 0);
+    ASSERT_TRUE(atomic_load(&counted_live) == 0);
+    lum_allocator_destroy(counted_backing);
+    counted_backing = NULL;
+    return true;
+}
+
+// **Define test cases**
+TestCase lum_timer_wheel_tests[] = {{"test_timer_wheel_ordering", test_timer_wheel_ordering},
+                                    {"test_timer_wheel_edges", test_timer_wheel_edges},
+                                    {"test_scheduler_submit_after", test_scheduler_submit_after},
+                                    {"test_scheduler_periodic", test_scheduler_periodic},
+                                    {"test_scheduler_destroy_pending_timers",
+                                     test_scheduler_destroy_pending_timers}};
+
+// **Test runner function**
+int lum_timer_wheel_tests_count = sizeof(lum_timer_wheel_tests) / sizeof(TestCase);